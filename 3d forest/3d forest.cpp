@@ -8,19 +8,35 @@
 #include <glm/gtx/norm.hpp>     // Include for glm::length2 (squared length/distance)
 #include <glm/gtx/string_cast.hpp> // For printing vectors (debugging)
 
+#include "world.h"
+#include "raycast.h"
+#include "dynamic_resolution.h"
+#include "player.h"
+#include "multiplayer.h"
+#include "export.h"
+#include "world_instances.h"
+#include "world_graph.h"
+#include "benchmark.h"
+#include "input_latency.h"
+#include "memory.h"
+#include "pvs.h"
+#include "world_batch.h"
+
 
 #include <iostream>
 #include <vector>
+#include <algorithm> // For std::max
 #include <string>
-#include <sstream>
-#include <cstdlib> // For rand() and srand()
+#include <cstdlib> // For std::strtoul
 #include <ctime>   // For time()
 #include <cstdio>  // For sscanf
 #include <cmath>   // For std::sqrt, std::abs
+#include <chrono>
 
 // --- Platform Specific - Include Win32 API ---
 #ifdef _WIN32 // Only include windows.h on Windows
 #define WIN32_LEAN_AND_MEAN // Exclude rarely-used stuff from Windows headers
+#define NOMINMAX // Keep std::min/std::max usable
 #include <windows.h>
 #include <CommCtrl.h> // Required for checkbox state checking
 #pragma comment(lib, "Comctl32.lib") // Link against Comctl32.lib for IsDlgButtonChecked
@@ -29,46 +45,12 @@
 // --- Configuration ---
 const unsigned int INITIAL_SCR_WIDTH = 1280; // Initial width
 const unsigned int INITIAL_SCR_HEIGHT = 720; // Initial height
-const float GROUND_SIZE = 500.0f;
-const int TREE_COUNT = 800;
-const int BUSH_COUNT = 1500; // Bushes currently don't have collision
-const int HOUSE_COUNT = 50;
-const int APARTMENT_TOWER_COUNT = 25; // Number of apartment towers
-
-// --- Physics & Player ---
-const float GRAVITY = 9.81f * 2.0f; // Adjusted gravity strength
-const float JUMP_FORCE = 8.0f;
-const float PLAYER_EYE_HEIGHT = 1.7f; // How high the camera is off the player's feet
-const float PLAYER_RADIUS = 0.3f;     // Player's collision radius for horizontal checks
-const float GROUND_LEVEL = -0.45f;    // Y-coordinate of the ground surface (-0.5f center + 0.1f/2 scale)
-const float PLAYER_BASE_SPEED = 5.0f; // *** Base walking/flying speed ***
-const float SPRINT_MULTIPLIER = 1.8f; // *** Speed multiplier when sprinting/flying faster ***
-const float FLY_VERTICAL_SPEED = 4.0f; // Speed for moving up/down in fly mode
-
-// --- Object Dimensions for Collision & Rendering ---
-const float TREE_TRUNK_RADIUS = 0.25f; // Half the scale width of the trunk (0.5f / 2)
-const float TREE_TRUNK_HEIGHT = 2.0f; // Scale height of the trunk
-const float HOUSE_BODY_WIDTH = 4.0f;
-const float HOUSE_BODY_DEPTH = 5.0f;
-const float HOUSE_BODY_HEIGHT = 3.0f; // Used for potential future vertical collision
-const float TOWER_WIDTH = 8.0f;
-const float TOWER_DEPTH = 8.0f;
-const float TOWER_HEIGHT = 40.0f; // Significantly taller than houses
-
-// --- NEW: Balcony Dimensions ---
-const float BALCONY_WIDTH = 2.5f;
-const float BALCONY_DEPTH = 1.5f;
-const float BALCONY_FLOOR_HEIGHT = 0.2f; // Thickness of the balcony floor
-const float BALCONY_RAILING_HEIGHT = 0.8f;
-const float BALCONY_RAILING_THICKNESS = 0.1f;
-const int   BALCONIES_PER_TOWER = 3; // How many balconies per tower
-
-// --- NEW: Sun Configuration ---
-const float SUN_DISTANCE_FACTOR = 0.7f; // How far out relative to ground size
-const float SUN_HEIGHT_FACTOR = 0.6f;   // How high relative to ground size
-const float SUN_SIZE = 30.0f;           // Scale factor for the sun cube
-const glm::vec3 SUN_COLOR = glm::vec3(1.0f, 0.95f, 0.7f); // Bright yellowish color
-const glm::vec3 SUN_POSITION = glm::vec3(GROUND_SIZE * SUN_DISTANCE_FACTOR, GROUND_SIZE * SUN_HEIGHT_FACTOR, -GROUND_SIZE * SUN_DISTANCE_FACTOR); // Fixed position
+const bool ENABLE_GPU_CULLING = true; // Use the GL 4.3 compute culling + multi-draw-indirect path when the context supports it
+const bool ENABLE_DYNAMIC_RESOLUTION = true; // Render offscreen at a scale that holds the GPU frame-time target
+const bool ENABLE_PVS = true; // Skip objects that the precomputed visible sets hide from the player's ground cell
+const bool ENABLE_LOW_LATENCY_INPUT = false; // Raw mouse motion, input polled right before use, no queued frames (stalls the CPU on the GPU; --low-latency)
+const float EDIT_REACH = 8.0f; // How far away objects can be chopped or planted
+const char* WINDOW_TITLE = "OpenGL Procedural Forest - Walking/Flying Sim";
 
 // --- Camera ---
 glm::vec3 cameraPos = glm::vec3(0.0f, GROUND_LEVEL + PLAYER_EYE_HEIGHT, 3.0f); // Start on the ground
@@ -84,6 +66,9 @@ float lastX = INITIAL_SCR_WIDTH / 2.0f;
 float lastY = INITIAL_SCR_HEIGHT / 2.0f;
 float fov = 45.0f;
 
+// --- Multiplayer (set when started with --connect) ---
+NetClient* activeNetClient = NULL;
+
 // --- Timing ---
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
@@ -97,35 +82,80 @@ int lastWindowWidth = INITIAL_SCR_WIDTH, lastWindowHeight = INITIAL_SCR_HEIGHT;
 // --- Sky Color ---
 glm::vec3 skyColor = glm::vec3(0.5f, 0.8f, 0.95f); // Default sky blue
 
-// --- Object Positions (Global for Collision Checks) ---
-std::vector<glm::vec3> treePositions;
-std::vector<glm::vec3> bushPositions;
-std::vector<glm::vec3> housePositions;
-std::vector<glm::vec3> apartmentTowerPositions; // Vector for tower positions
-
-// --- NEW: Balcony Data Structure and Global Vector ---
-struct Balcony {
-    glm::vec3 position; // World space center position of the balcony floor
-    glm::vec3 dimensions; // Width, Height (floor thickness), Depth
-    // Store railing positions relative to the center for easier drawing/collision
-    glm::vec3 railingFrontPosRel;
-    glm::vec3 railingLeftPosRel;
-    glm::vec3 railingRightPosRel;
-    glm::vec3 railingDimsFront; // Width, Height, Thickness
-    glm::vec3 railingDimsSide;  // Thickness, Height, Depth
+// --- Draw List (one entry per world instance slot, shared by both render paths) ---
+// Every object part is drawn as the same unit cube; the batch selects its
+// DrawArraysIndirectCommand slot on the GPU culling path. Edits rewrite only dirty slots.
+struct DrawInstance {
+    glm::mat4 model;
+    glm::vec3 color;
+    WorldPartType batch;
+    bool alive; // False for freed slots, which are skipped until reused
+};
+typedef ArenaVector<DrawInstance> DrawList;
+Arena drawListArena(MEMORY_GEOMETRY); // Before drawList, which it must outlive
+DrawList drawList((ArenaAllocator<DrawInstance>(&drawListArena)));
+WorldInstances worldInstances;
+Arena frameArena(MEMORY_FRAME); // Scratch for one frame, reset at the top of the loop
+
+// --- World Editing (left click chops, right click plants, 1/2/3 select tree/bush/house) ---
+WorldObjectType editPlaceType = OBJECT_TREE;
+bool leftMousePressedLastFrame = false;
+bool rightMousePressedLastFrame = false;
+
+// --- Live Generation Tweaks (F1-F5 select a category, +/- change its count, R re-rolls it) ---
+const int GEN_TWEAK_STEPS[GEN_NODE_COUNT] = { 100, 100, 10, 5, 1 }; // Trees, bushes, houses, towers, balconies per tower
+WorldGenGraph worldGraph;
+WorldGenParams worldGenParams;
+WorldGenNode tweakNode = GEN_TREES;
+bool tweakKeysPressedLastFrame = false;
+
+// --- GPU Culling Data (GL 4.3+ only) ---
+// Layouts must match the std430 blocks in the culling/indirect shaders.
+const uint32_t GPU_UPLOAD_CHUNK = 512; // Objects staged per glBufferSubData, out of the frame arena
+struct GpuObject {
+    glm::mat4 model;
+    glm::vec4 color;
+    glm::vec4 boundsCenter; // xyz = world AABB center, w = batch index
+    glm::vec4 boundsExtent; // xyz = world AABB half extents, w = 1 if alive, 0 for a freed slot
+};
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+struct GpuCuller {
+    unsigned int cullProgram = 0;
+    unsigned int drawProgram = 0;
+    unsigned int objectBuffer = 0;   // SSBO: GpuObject[]
+    unsigned int commandBuffer = 0;  // SSBO + GL_DRAW_INDIRECT_BUFFER: DrawArraysIndirectCommand[PART_COUNT]
+    unsigned int visibleBuffer = 0;  // SSBO + instanced vertex attribute: visible object indices
+    unsigned int pvsBuffer = 0;      // SSBO: one bit per slot, set if in the player's potentially visible set
+    bool usePvs = false;             // pvsBuffer holds the current cell's set
+    unsigned int VAO = 0;
+    GLuint objectCount = 0;          // Slots in use, dead or alive
+    GLuint objectCapacity = 0;       // Slots allocated in objectBuffer
+    GLuint batchCapacity[PART_COUNT] = {}; // Length of each batch's range in visibleBuffer
+    std::vector<DrawArraysIndirectCommand> commandTemplate; // instanceCount = 0, reset each frame
 };
-std::vector<Balcony> balconyData; // Global vector to store all balconies
 
 // --- Function Prototypes ---
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void processInput(GLFWwindow* window); // Updated prototype (no functional change needed)
+void processEditInput(GLFWwindow* window);
+void processGenerationInput(GLFWwindow* window);
 unsigned int compileShader(GLenum type, const char* source);
 unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource);
-void generateObjectPositions(std::vector<glm::vec3>& positions, float areaSize, int count);
-void generateTowersAndBalconies(float areaSize, int towerCount, int balconiesPerTower); // NEW function
 void toggleFullscreen(GLFWwindow* window);
-bool checkCollision(glm::vec3 nextPos); // Collision detection function
+void buildDrawList(DrawList& list, const WorldInstances& instances);
+size_t updateDrawList(DrawList& list, const WorldInstances& instances, const std::vector<InstanceRange>& ranges);
+unsigned int createComputeProgram(const char* computeSource);
+bool initGpuCuller(GpuCuller& culler, unsigned int cubeVBO, const DrawList& list, const size_t* liveCountByType, Arena& scratch);
+size_t updateGpuCuller(GpuCuller& culler, const DrawList& list, const size_t* liveCountByType, const std::vector<InstanceRange>& ranges, Arena& scratch);
+void setGpuCullerPvs(GpuCuller& culler, const PvsState& pvs);
+void drawWithGpuCulling(const GpuCuller& culler, const glm::mat4& projection, const glm::mat4& view);
+void destroyGpuCuller(GpuCuller& culler);
 
 // --- Win32 Specific Prototypes & Globals ---
 #ifdef _WIN32
@@ -136,9 +166,7 @@ bool checkCollision(glm::vec3 nextPos); // Collision detection function
 
 HWND hEditSeed = NULL;
 HWND hCheckFly = NULL; // *** NEW: Handle for the checkbox ***
-unsigned int g_seed = 0;
 bool g_seedChosen = false;
-bool g_flyModeEnabled = false; // *** NEW: Global flag for fly mode ***
 
 LRESULT CALLBACK SeedDialogProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 bool ShowSeedDialog(HINSTANCE hInstance);
@@ -160,34 +188,218 @@ const char* fragmentShaderSource = R"(
     void main() { FragColor = vec4(objectColor, 1.0); }
 )";
 
+// --- GPU Culling Shaders (GL 4.3+) ---
+// One thread per object: skip it if the player's PVS hides it, test its AABB against the
+// frustum and, if visible, append its index to the instance list of its batch's indirect command.
+const char* cullComputeShaderSource = R"(
+    #version 430 core
+    layout (local_size_x = 64) in;
+    struct Object { mat4 model; vec4 color; vec4 boundsCenter; vec4 boundsExtent; };
+    struct DrawCommand { uint count; uint instanceCount; uint first; uint baseInstance; };
+    layout (std430, binding = 0) readonly buffer Objects { Object objects[]; };
+    layout (std430, binding = 1) buffer Commands { DrawCommand commands[]; };
+    layout (std430, binding = 2) writeonly buffer Visible { uint visibleIndices[]; };
+    layout (std430, binding = 3) readonly buffer Pvs { uint pvsBits[]; };
+    uniform vec4 frustumPlanes[6];
+    uniform uint objectCount;
+    uniform bool usePvs;
+    void main() {
+        uint id = gl_GlobalInvocationID.x;
+        if (id >= objectCount || objects[id].boundsExtent.w == 0.0) return; // Past the end or a freed slot
+        if (usePvs && (pvsBits[id >> 5] & (1u << (id & 31u))) == 0u) return; // Hidden from the player's cell
+        vec3 center = objects[id].boundsCenter.xyz;
+        vec3 extent = objects[id].boundsExtent.xyz;
+        for (int i = 0; i < 6; ++i) {
+            vec4 plane = frustumPlanes[i];
+            if (dot(plane.xyz, center) + plane.w < -dot(extent, abs(plane.xyz))) return;
+        }
+        uint batch = uint(objects[id].boundsCenter.w);
+        uint slot = atomicAdd(commands[batch].instanceCount, 1u);
+        visibleIndices[commands[batch].baseInstance + slot] = id;
+    }
+)";
+// aObjectIndex is an instanced attribute sourced from the visible list, so the
+// command's baseInstance offsets it into the batch's range.
+const char* indirectVertexShaderSource = R"(
+    #version 430 core
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in uint aObjectIndex;
+    struct Object { mat4 model; vec4 color; vec4 boundsCenter; vec4 boundsExtent; };
+    layout (std430, binding = 0) readonly buffer Objects { Object objects[]; };
+    uniform mat4 view;
+    uniform mat4 projection;
+    flat out vec3 vColor;
+    void main() {
+        gl_Position = projection * view * objects[aObjectIndex].model * vec4(aPos, 1.0);
+        vColor = objects[aObjectIndex].color.rgb;
+    }
+)";
+const char* indirectFragmentShaderSource = R"(
+    #version 430 core
+    flat in vec3 vColor;
+    out vec4 FragColor;
+    void main() { FragColor = vec4(vColor, 1.0); }
+)";
+
 // --- Main Function ---
 int main(int argc, char** argv) {
 
-#ifdef _WIN32
-    // --- Show Win32 Seed Dialog FIRST ---
-    HINSTANCE hInstance = GetModuleHandle(NULL);
-    if (!ShowSeedDialog(hInstance)) {
-        if (!g_seedChosen) {
-            std::cerr << "Seed selection cancelled. Exiting." << std::endl;
-            return 0;
+    // --- Command Line ---
+    bool gpuCullingRequested = ENABLE_GPU_CULLING;
+    bool pvsRequested = ENABLE_PVS;
+    size_t rayBenchCount = 0;
+    bool dynamicResolutionRequested = ENABLE_DYNAMIC_RESOLUTION;
+    DynamicResolutionSettings drsSettings;
+    bool serverRequested = false, netBenchRequested = false, flyRequested = false;
+    uint16_t serverPort = NET_DEFAULT_PORT;
+    unsigned int seedArg = 0;
+    std::string connectTarget;
+    std::string exportPath;
+    bool exportExpanded = false, exportBenchRequested = false;
+    bool editBenchRequested = false, microBenchRequested = false, pvsBenchRequested = false, batchRequested = false;
+    InputLatencySettings latencySettings;
+    latencySettings.rawMouseMotion = latencySettings.latePolling = ENABLE_LOW_LATENCY_INPUT;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--no-gpu-culling") gpuCullingRequested = false;
+        else if (arg == "--no-drs") dynamicResolutionRequested = false;
+        else if (arg == "--no-pvs") pvsRequested = false;
+        else if (arg == "--pvsbench") pvsBenchRequested = true;
+        else if (arg == "--drs-target" && hasValue) drsSettings.targetFrameMs = std::strtof(argv[++i], NULL);
+        else if (arg == "--drs-min" && hasValue) drsSettings.minScale = std::strtof(argv[++i], NULL);
+        else if (arg == "--drs-max" && hasValue) drsSettings.maxScale = std::strtof(argv[++i], NULL);
+        else if (arg == "--raybench") rayBenchCount = (hasValue && argv[i + 1][0] != '-') ? std::strtoul(argv[++i], NULL, 10) : 1000000;
+        else if (arg == "--server") {
+            serverRequested = true;
+            if (hasValue && argv[i + 1][0] != '-') serverPort = static_cast<uint16_t>(std::strtoul(argv[++i], NULL, 10));
         }
+        else if (arg == "--seed" && hasValue) seedArg = static_cast<unsigned int>(std::strtoul(argv[++i], NULL, 10));
+        else if (arg == "--fly") flyRequested = true;
+        else if (arg == "--connect" && hasValue) connectTarget = argv[++i];
+        else if (arg == "--netbench") netBenchRequested = true;
+        else if (arg == "--export" && hasValue) exportPath = argv[++i];
+        else if (arg == "--export-expanded") exportExpanded = true;
+        else if (arg == "--exportbench") exportBenchRequested = true;
+        else if (arg == "--editbench") editBenchRequested = true;
+        else if (arg == "--microbench") microBenchRequested = true;
+        else if (arg == "--batch") batchRequested = true;
+        else if (arg == "--low-latency") latencySettings.rawMouseMotion = latencySettings.latePolling = true;
+        else if (arg == "--latency-wait") latencySettings.waitForDeadline = true;
+        else if (arg == "--latency-margin" && hasValue) latencySettings.safetyMarginMs = std::strtof(argv[++i], NULL);
+    }
+
+    // --- Headless Ray Query Benchmark (no dialog, window or GL) ---
+    if (rayBenchCount > 0) {
+        generateWorld(1); // Fixed world so runs are comparable
+        runRayCastBenchmark(rayBenchCount);
+        return 0;
+    }
+
+    // --- Headless Micro-Benchmarks (also built standalone as forest_bench) ---
+    if (microBenchRequested) {
+        return runMicroBenchmarkCommand(argc, argv);
+    }
+
+    // --- Headless Batch World Generation (also built standalone as forest_batch) ---
+    if (batchRequested) {
+        return runWorldBatchCommand(argc, argv);
     }
-    std::cout << "Using seed: " << (g_seed == 0 ? "Random (time-based)" : std::to_string(g_seed)) << std::endl;
-    std::cout << "Fly Mode: " << (g_flyModeEnabled ? "Enabled" : "Disabled") << std::endl; // *** NEW: Print fly mode status ***
+
+    // --- Headless Visibility Precomputation Benchmark ---
+    if (pvsBenchRequested) {
+        runPvsBenchmark();
+        return 0;
+    }
+
+    // --- Headless World Editing Benchmark ---
+    if (editBenchRequested) {
+        runWorldEditBenchmark();
+        return 0;
+    }
+
+    // --- Headless World Export ---
+    if (exportBenchRequested) {
+        runExportBenchmark();
+        return 0;
+    }
+    if (!exportPath.empty()) {
+        unsigned int seed = seedArg != 0 ? seedArg : static_cast<unsigned int>(time(0));
+        generateWorld(seed);
+        ExportStats stats;
+        if (!exportWorld(exportPath, exportFormatForPath(exportPath, exportExpanded), &stats)) return -1;
+        std::cout << "Exported seed " << seed << " to " << exportPath << ": " << stats.objects << " objects (" << stats.parts << " parts), "
+                  << stats.bytesWritten << " bytes in " << stats.seconds << " s, " << stats.objects / stats.seconds << " objects/s, peak RSS "
+                  << getPeakRssBytes() / (1024 * 1024) << " MiB" << std::endl;
+        return 0;
+    }
+
+    // --- Headless Multiplayer Modes ---
+    if (netBenchRequested) {
+        runNetBenchmark();
+        return 0;
+    }
+    if (serverRequested) {
+        return runServer(serverPort, seedArg, flyRequested);
+    }
+
+    // --- Join a Server (the world comes from its seed, so skip the dialog) ---
+    NetClient netClient;
+    UdpSocket netSocket;
+    if (!connectTarget.empty()) {
+        std::string host = connectTarget;
+        uint16_t port = NET_DEFAULT_PORT;
+        size_t colon = host.rfind(':');
+        if (colon != std::string::npos) {
+            port = static_cast<uint16_t>(std::strtoul(host.c_str() + colon + 1, NULL, 10));
+            host = host.substr(0, colon);
+        }
+        NetAddress serverAddress;
+        if (!netStartup() || !resolveAddress(host, port, serverAddress) || !openUdpSocket(netSocket, 0)) {
+            return -1;
+        }
+        uint32_t token = static_cast<uint32_t>(time(0)) ^ (static_cast<uint32_t>(clock()) << 16) ^ getSocketPort(netSocket);
+        initNetClient(netClient, &netSocket, serverAddress, token == 0 ? 1 : token);
+        std::cout << "Connecting to " << addressToString(serverAddress) << "..." << std::endl;
+        if (!connectToServer(netClient, NET_TIMEOUT_SECONDS)) {
+            std::cerr << "ERROR::NET::CONNECT_TIMEOUT " << connectTarget << std::endl;
+            closeUdpSocket(netSocket);
+            netShutdown();
+            return -1;
+        }
+        g_seed = netClient.seed;
+        g_flyModeEnabled = netClient.flyMode;
+        activeNetClient = &netClient;
+        std::cout << "Connected as player " << netClient.id << ", seed " << g_seed
+                  << ", fly mode " << (g_flyModeEnabled ? "on" : "off") << std::endl;
+    }
+    else {
+#ifdef _WIN32
+        // --- Show Win32 Seed Dialog FIRST ---
+        HINSTANCE hInstance = GetModuleHandle(NULL);
+        if (!ShowSeedDialog(hInstance)) {
+            if (!g_seedChosen) {
+                std::cerr << "Seed selection cancelled. Exiting." << std::endl;
+                return 0;
+            }
+        }
+        std::cout << "Using seed: " << (g_seed == 0 ? "Random (time-based)" : std::to_string(g_seed)) << std::endl;
+        std::cout << "Fly Mode: " << (g_flyModeEnabled ? "Enabled" : "Disabled") << std::endl; // *** NEW: Print fly mode status ***
 
 #else
-    std::cout << "Non-Windows platform. Using default random seed." << std::endl;
-    g_seed = 0;
-    g_flyModeEnabled = false; // Default to disabled on non-Windows
+        std::cout << "Non-Windows platform. Using default random seed." << std::endl;
+        g_seed = 0;
+        g_flyModeEnabled = false; // Default to disabled on non-Windows
 #endif
+    }
 
-    // --- Seed Random Number Generator ONCE ---
+    // --- Pick the World Seed ONCE (every generated category derives its stream from it) ---
     if (g_seed == 0) {
-        srand(static_cast<unsigned int>(time(0)));
-        std::cout << "Seeding with time(0)" << std::endl;
+        worldGenParams.seed = static_cast<unsigned int>(time(0));
+        std::cout << "Seeding with time(0): " << worldGenParams.seed << std::endl;
     }
     else {
-        srand(g_seed);
+        worldGenParams.seed = g_seed;
         std::cout << "Seeding with " << g_seed << std::endl;
     }
 
@@ -206,15 +418,27 @@ int main(int argc, char** argv) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
     }
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
     // --- 2. Create GLFW Window ---
-    GLFWwindow* window = glfwCreateWindow(INITIAL_SCR_WIDTH, INITIAL_SCR_HEIGHT, "OpenGL Procedural Forest - Walking/Flying Sim", NULL, NULL); // Update title
+    // Ask for 4.3 first when GPU culling is wanted, then fall back to the 3.3 baseline.
+    GLFWwindow* window = NULL;
+    if (gpuCullingRequested) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(INITIAL_SCR_WIDTH, INITIAL_SCR_HEIGHT, WINDOW_TITLE, NULL, NULL);
+        if (window == NULL) {
+            std::cout << "OpenGL 4.3 context unavailable, falling back to 3.3" << std::endl;
+        }
+    }
+    if (window == NULL) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(INITIAL_SCR_WIDTH, INITIAL_SCR_HEIGHT, WINDOW_TITLE, NULL, NULL); // Update title
+    }
     if (window == NULL) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -226,6 +450,14 @@ int main(int argc, char** argv) {
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     glfwGetWindowPos(window, &lastWindowPosX, &lastWindowPosY);
 
+    // Low-latency input (waiting for the vsync deadline needs it, and vsync on)
+    InputLatency inputLatency;
+    latencySettings.waitForDeadline = latencySettings.waitForDeadline && latencySettings.latePolling;
+    initInputLatency(inputLatency, window, latencySettings);
+    if (latencySettings.waitForDeadline) glfwSwapInterval(1);
+    std::cout << "Input: " << (latencySettings.latePolling ? "low latency" : "polled after present")
+              << (latencySettings.waitForDeadline ? ", waiting for the vsync deadline" : "") << std::endl;
+
 
     // --- 3. Initialize GLAD ---
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -272,14 +504,49 @@ int main(int argc, char** argv) {
     glBindVertexArray(0);
 
     // --- 7. Generate Object Positions ---
-    generateObjectPositions(treePositions, GROUND_SIZE, TREE_COUNT);
-    generateObjectPositions(bushPositions, GROUND_SIZE, BUSH_COUNT);
-    generateObjectPositions(housePositions, GROUND_SIZE, HOUSE_COUNT);
-    // NEW: Generate towers and their balconies together
-    generateTowersAndBalconies(GROUND_SIZE, APARTMENT_TOWER_COUNT, BALCONIES_PER_TOWER);
+    updateWorldGraph(worldGraph, worldGenParams);
+    std::cout << "Generated " << getWorldObjectCount(OBJECT_TOWER) << " towers and " << getWorldObjectCount(OBJECT_BALCONY) << " balconies." << std::endl;
+    buildWorldInstances(worldInstances);
+    buildDrawList(drawList, worldInstances);
+    std::vector<InstanceRange> dirtyRanges;
+    std::vector<NetRemotePlayer> remotePlayers;
+
+    // --- 7b. GPU Culling Setup (needs a 4.3 context, else keep the glDrawArrays loop) ---
+    GpuCuller gpuCuller;
+    bool useGpuCulling = gpuCullingRequested && GLAD_GL_VERSION_4_3 && initGpuCuller(gpuCuller, VBO, drawList, worldInstances.liveCountByType, frameArena);
+    std::cout << "Render path: " << (useGpuCulling ? "GPU culling + glMultiDrawArraysIndirect" : "glDrawArrays loop") << std::endl;
+
+    // --- 7c. Potentially Visible Sets (built in the background; culling as usual until ready) ---
+    PvsState pvs;
+    if (pvsRequested) std::cout << "PVS: building in the background" << std::endl;
+
+    // --- 7d. Dynamic Resolution Setup ---
+    DynamicResolution drs;
+    bool useDynamicResolution = dynamicResolutionRequested && initDynamicResolution(drs, drsSettings);
+    if (useDynamicResolution) {
+        std::cout << "Dynamic resolution: target " << drs.settings.targetFrameMs << " ms, scale "
+                  << drs.settings.minScale << " - " << drs.settings.maxScale << std::endl;
+    }
+    float lastTitleUpdate = 0.0f;
+
+    // Memory report at startup, then every MEMORY_REPORT_SECONDS with the frames that allocated
+    MemoryFrameTracker memoryTracker;
+    initMemoryFrameTracker(memoryTracker, frameArena, glfwGetTime());
+    // Edit uploads, summed and printed every INSTANCE_REPORT_SECONDS
+    InstanceUploadReport uploadReport;
+    uploadReport.lastReportTime = glfwGetTime();
 
     // --- 8. Rendering Loop ---
     while (!glfwWindowShouldClose(window)) {
+        beginMemoryFrame(memoryTracker);
+
+        // Low latency: optionally sleep toward the vsync deadline, then sample input for this frame
+        beginInputLatencyFrame(inputLatency);
+        if (latencySettings.latePolling) {
+            glfwPollEvents();
+            markInputSampled(inputLatency);
+        }
+
         // Timing
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
@@ -290,167 +557,137 @@ int main(int argc, char** argv) {
 
         // Input & Physics Update (handles movement, gravity, collision, sprinting, FLY MODE)
         processInput(window); // Calls the updated function
+        processEditInput(window);
+        processGenerationInput(window);
+
+        // Server gone quiet: keep playing offline from where the player stands
+        if (activeNetClient && !activeNetClient->connected) {
+            std::cout << "Lost the server, continuing offline" << std::endl;
+            closeUdpSocket(netSocket);
+            netShutdown();
+            activeNetClient = NULL;
+        }
 
-        // Rendering
-        glClearColor(skyColor.r, skyColor.g, skyColor.b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Regenerate only the categories whose parameters changed; their slots become dirty below
+        unsigned int regenerated = updateWorldGraph(worldGraph, worldGenParams);
+        for (int node = 0; node < GEN_NODE_COUNT; ++node) {
+            if (!(regenerated & (1u << node))) continue;
+            WorldObjectType type = WORLD_GEN_NODES[node].object;
+            auto start = std::chrono::steady_clock::now();
+            size_t slots = rebuildInstancedObjects(worldInstances, type);
+            double slotMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "Regenerated " << WORLD_GEN_NODES[node].name << " (" << getWorldObjectCount(type) << " objects) in "
+                      << worldGraph.nodeMs[node] << " ms, " << slots << " slots rewritten in " << slotMs << " ms" << std::endl;
+        }
 
-        glUseProgram(shaderProgram);
+        // Apply this frame's edits: only the slots they touched are rewritten and uploaded
+        takeDirtyRanges(worldInstances, dirtyRanges);
+        if (!dirtyRanges.empty()) {
+            updateDrawList(drawList, worldInstances, dirtyRanges);
+            size_t uploadBytes = useGpuCulling ? updateGpuCuller(gpuCuller, drawList, worldInstances.liveCountByType, dirtyRanges, frameArena) : 0;
+            addInstanceUpload(uploadReport, dirtyRanges, uploadBytes);
+        }
+        updateInstanceUploadReport(uploadReport, drawList.size() * sizeof(GpuObject), glfwGetTime());
+
+        // Visible sets: a changed house or tower drops them until a rebuild, other changes just
+        // show their slots; the player's cell set is decoded only when the player enters another cell
+        if (pvsRequested) {
+            bool editsShown = updatePvsEdits(pvs, worldInstances, dirtyRanges, glfwGetTime());
+            bool cellChanged = updatePvs(pvs, worldInstances, cameraPos, g_flyModeEnabled, glfwGetTime());
+            if ((editsShown || cellChanged) && useGpuCulling) setGpuCullerPvs(gpuCuller, pvs);
+        }
 
-        // Matrices
+        // Rendering (offscreen at the dynamic resolution scale when enabled)
         int currentWidth, currentHeight;
         glfwGetFramebufferSize(window, &currentWidth, &currentHeight);
+        bool renderingOffscreen = useDynamicResolution && beginDynamicResolutionFrame(drs, currentWidth, currentHeight);
+
+        glClearColor(skyColor.r, skyColor.g, skyColor.b, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Matrices
         // Prevent division by zero if window is minimized
         if (currentHeight == 0) currentHeight = 1;
         glm::mat4 projection = glm::perspective(glm::radians(fov), (float)currentWidth / (float)currentHeight, 0.1f, GROUND_SIZE * 2.0f); // Adjust far plane if needed
         glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-
-        GLint objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
-        GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
-
-        glBindVertexArray(VAO);
-
-        // Draw Ground (Unchanged)
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, -0.5f, 0.0f)); // Keep visual center
-        model = glm::scale(model, glm::vec3(GROUND_SIZE, 0.1f, GROUND_SIZE));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform3f(objectColorLoc, 0.2f, 0.8f, 0.2f);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-        // --- *** NEW: Draw Sun *** ---
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, SUN_POSITION);
-        model = glm::scale(model, glm::vec3(SUN_SIZE));
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniform3fv(objectColorLoc, 1, glm::value_ptr(SUN_COLOR));
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-        // --- *** END Draw Sun *** ---
-
-
-        // Draw Trees (Unchanged)
-        glm::vec3 trunkColor = glm::vec3(0.6f, 0.4f, 0.2f);
-        glm::vec3 leavesColor = glm::vec3(0.1f, 0.5f, 0.1f);
-        for (const auto& pos : treePositions) {
-            // Trunk
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pos + glm::vec3(0.0f, TREE_TRUNK_HEIGHT * 0.5f, 0.0f));
-            model = glm::scale(model, glm::vec3(TREE_TRUNK_RADIUS * 2.0f, TREE_TRUNK_HEIGHT, TREE_TRUNK_RADIUS * 2.0f));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(trunkColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            // Leaves
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pos + glm::vec3(0.0f, TREE_TRUNK_HEIGHT + 0.75f, 0.0f));
-            model = glm::scale(model, glm::vec3(1.5f, 1.5f, 1.5f));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(leavesColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
 
-        // Draw Bushes (Unchanged)
-        glm::vec3 bushColor = glm::vec3(0.2f, 0.6f, 0.1f);
-        const float bushScaleFactor = 0.8f;
-        for (const auto& pos : bushPositions) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, pos + glm::vec3(0.0f, bushScaleFactor * 0.5f, 0.0f));
-            model = glm::scale(model, glm::vec3(bushScaleFactor));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(bushColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+        if (useGpuCulling) {
+            drawWithGpuCulling(gpuCuller, projection, view);
         }
-
-        // Draw Houses (Unchanged)
-        glm::vec3 houseBodyColor = glm::vec3(0.8f, 0.7f, 0.5f);
-        glm::vec3 houseRoofColor = glm::vec3(0.4f, 0.2f, 0.1f);
-        glm::vec3 houseDoorColor = glm::vec3(0.3f, 0.15f, 0.05f);
-        glm::vec3 houseWindowColor = glm::vec3(0.6f, 0.8f, 0.9f);
-        const float roofHeight = 0.3f; const float roofOverhang = 0.4f;
-        const float doorWidth = 1.0f; const float doorHeight = 2.0f; const float windowSize = 0.8f;
-        for (const auto& pos : housePositions) {
-            glm::mat4 identityMat = glm::mat4(1.0f);
-            glm::vec3 bodyCenterPos = pos + glm::vec3(0.0f, HOUSE_BODY_HEIGHT * 0.5f, 0.0f);
-            // Body
-            model = glm::mat4(1.0f); model = glm::translate(model, bodyCenterPos); model = glm::scale(model, glm::vec3(HOUSE_BODY_WIDTH, HOUSE_BODY_HEIGHT, HOUSE_BODY_DEPTH));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); glUniform3fv(objectColorLoc, 1, glm::value_ptr(houseBodyColor)); glDrawArrays(GL_TRIANGLES, 0, 36);
-            // Roof
-            model = glm::mat4(1.0f); model = glm::translate(model, bodyCenterPos + glm::vec3(0.0f, HOUSE_BODY_HEIGHT * 0.5f + roofHeight * 0.5f, 0.0f)); model = glm::scale(model, glm::vec3(HOUSE_BODY_WIDTH + roofOverhang * 2.0f, roofHeight, HOUSE_BODY_DEPTH + roofOverhang * 2.0f));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); glUniform3fv(objectColorLoc, 1, glm::value_ptr(houseRoofColor)); glDrawArrays(GL_TRIANGLES, 0, 36);
-            // Door
-            model = glm::mat4(1.0f); glm::vec3 doorOffset = glm::vec3(0.0f, -HOUSE_BODY_HEIGHT * 0.5f + doorHeight * 0.5f, HOUSE_BODY_DEPTH * 0.5f + 0.01f); model = glm::translate(model, bodyCenterPos + doorOffset); model = glm::scale(model, glm::vec3(doorWidth, doorHeight, 0.1f));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); glUniform3fv(objectColorLoc, 1, glm::value_ptr(houseDoorColor)); glDrawArrays(GL_TRIANGLES, 0, 36);
-            // Window 1
-            model = glm::mat4(1.0f); glm::vec3 win1Offset = glm::vec3(HOUSE_BODY_WIDTH * 0.25f, 0.0f, HOUSE_BODY_DEPTH * 0.5f + 0.01f); model = glm::translate(model, bodyCenterPos + win1Offset); model = glm::scale(model, glm::vec3(windowSize, windowSize, 0.1f));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); glUniform3fv(objectColorLoc, 1, glm::value_ptr(houseWindowColor)); glDrawArrays(GL_TRIANGLES, 0, 36);
-            // Window 2
-            model = glm::mat4(1.0f); glm::vec3 win2Offset = glm::vec3(HOUSE_BODY_WIDTH * 0.5f + 0.01f, 0.0f, 0.0f); model = glm::translate(model, bodyCenterPos + win2Offset); model = glm::scale(model, glm::vec3(0.1f, windowSize, windowSize));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); glUniform3fv(objectColorLoc, 1, glm::value_ptr(houseWindowColor)); glDrawArrays(GL_TRIANGLES, 0, 36);
+        else {
+            glUseProgram(shaderProgram);
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+
+            GLint objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
+            GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
+
+            glBindVertexArray(VAO);
+            for (size_t slot = 0; slot < drawList.size(); ++slot) {
+                const DrawInstance& inst = drawList[slot];
+                if (!inst.alive || (pvs.cell >= 0 && !isPvsSlotVisible(pvs, slot))) continue;
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(inst.model));
+                glUniform3fv(objectColorLoc, 1, glm::value_ptr(inst.color));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
         }
 
-        // Draw Apartment Towers (Main Body) - Unchanged
-        glm::vec3 towerColor = glm::vec3(0.6f, 0.6f, 0.65f); // A grey color
-        for (const auto& pos : apartmentTowerPositions) {
-            model = glm::mat4(1.0f);
-            glm::vec3 towerCenterPos = pos + glm::vec3(0.0f, TOWER_HEIGHT * 0.5f, 0.0f);
-            model = glm::translate(model, towerCenterPos);
-            model = glm::scale(model, glm::vec3(TOWER_WIDTH, TOWER_HEIGHT, TOWER_DEPTH));
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(towerColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+        // Other players: a body-sized box from their feet to just above eye height
+        if (activeNetClient) {
+            getRemotePlayers(*activeNetClient, glfwGetTime(), remotePlayers);
+            glUseProgram(shaderProgram);
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+            glUniform3f(glGetUniformLocation(shaderProgram, "objectColor"), 0.9f, 0.3f, 0.2f);
+            GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
+            glBindVertexArray(VAO);
+            for (const auto& player : remotePlayers) {
+                float bodyHeight = PLAYER_EYE_HEIGHT + 0.2f;
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), player.position + glm::vec3(0.0f, bodyHeight * 0.5f - PLAYER_EYE_HEIGHT, 0.0f));
+                model = glm::rotate(model, glm::radians(-player.yaw), glm::vec3(0.0f, 1.0f, 0.0f));
+                model = glm::scale(model, glm::vec3(PLAYER_RADIUS * 2.0f, bodyHeight, PLAYER_RADIUS * 2.0f));
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
         }
 
-        // --- NEW: Draw Balconies and Railings --- (Unchanged)
-        glm::vec3 balconyFloorColor = glm::vec3(0.7f, 0.7f, 0.75f); // Slightly lighter grey
-        glm::vec3 railingColor = glm::vec3(0.4f, 0.4f, 0.4f);      // Darker grey
-        for (const auto& bal : balconyData) {
-            // Draw Balcony Floor
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, bal.position); // Already center position
-            model = glm::scale(model, bal.dimensions);   // Use stored dimensions
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(balconyFloorColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-
-            // Draw Railings (relative to balcony center)
-            // Front Railing
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, bal.position + bal.railingFrontPosRel); // Use relative position
-            model = glm::scale(model, bal.railingDimsFront); // Use specific railing dimensions
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(railingColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-
-            // Left Railing
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, bal.position + bal.railingLeftPosRel);
-            model = glm::scale(model, bal.railingDimsSide);
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(railingColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-
-            // Right Railing
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, bal.position + bal.railingRightPosRel);
-            model = glm::scale(model, bal.railingDimsSide);
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-            glUniform3fv(objectColorLoc, 1, glm::value_ptr(railingColor));
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        }
+        glBindVertexArray(0); // Unbind VAO
 
+        // Upscale to the window
+        if (renderingOffscreen) {
+            endDynamicResolutionFrame(drs);
+        }
 
-        glBindVertexArray(0); // Unbind VAO
+        // Show the current render scale in the title twice a second
+        if (useDynamicResolution && currentFrame - lastTitleUpdate > 0.5f) {
+            const size_t titleSize = 256;
+            char* title = arenaAllocateArray<char>(frameArena, titleSize);
+            snprintf(title, titleSize, "%s | Render scale %.1f%% | GPU %.1f ms", WINDOW_TITLE, drs.scale * 100.0f, drs.smoothedGpuMs);
+            glfwSetWindowTitle(window, title);
+            lastTitleUpdate = currentFrame;
+        }
 
-        // Swap Buffers & Poll Events
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Swap Buffers & Poll Events (polling already happened at the top in low-latency mode)
+        presentInputLatencyFrame(inputLatency, window, useDynamicResolution ? drs.smoothedGpuMs : 0.0f);
+        if (!latencySettings.latePolling) {
+            glfwPollEvents();
+            markInputSampled(inputLatency);
+        }
+        endMemoryFrame(memoryTracker, glfwGetTime());
     }
 
     // --- 9. Cleanup ---
+    shutdownPvs(pvs);
+    if (useGpuCulling) destroyGpuCuller(gpuCuller);
+    if (useDynamicResolution) destroyDynamicResolution(drs);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteProgram(shaderProgram);
+    if (activeNetClient) {
+        disconnectFromServer(netClient);
+        closeUdpSocket(netSocket);
+        netShutdown();
+    }
 
     glfwDestroyWindow(window);
     glfwTerminate();
@@ -482,204 +719,122 @@ void toggleFullscreen(GLFWwindow* window) {
     glViewport(0, 0, width, height);
 }
 
-// Check collision between player at nextPos and world obstacles (trees, houses, towers, balconies) - (Unchanged)
-// NOTE: This function is now only called if g_flyModeEnabled is false.
-bool checkCollision(glm::vec3 nextPos) {
-    // Player's horizontal position (ignore Y for this check initially)
-    glm::vec2 playerPosXZ(nextPos.x, nextPos.z);
-
-    // Check against Trees (Cylinder collision) - Unchanged
-    for (const auto& treeBasePos : treePositions) {
-        glm::vec2 treePosXZ(treeBasePos.x, treeBasePos.z);
-        float distSq = glm::length2(playerPosXZ - treePosXZ);
-        float minCollisionDist = PLAYER_RADIUS + TREE_TRUNK_RADIUS;
-        if (distSq < minCollisionDist * minCollisionDist) {
-            return true; // Collision detected
-        }
-    }
-
-    // Check against Houses (AABB collision) - Unchanged
-    for (const auto& houseBasePos : housePositions) {
-        float objMinX = houseBasePos.x - HOUSE_BODY_WIDTH / 2.0f;
-        float objMaxX = houseBasePos.x + HOUSE_BODY_WIDTH / 2.0f;
-        float objMinZ = houseBasePos.z - HOUSE_BODY_DEPTH / 2.0f;
-        float objMaxZ = houseBasePos.z + HOUSE_BODY_DEPTH / 2.0f;
-        float closestX = glm::clamp(playerPosXZ.x, objMinX, objMaxX);
-        float closestZ = glm::clamp(playerPosXZ.y, objMinZ, objMaxZ); // Use playerPosXZ.y for Z component
-        glm::vec2 closestPointXZ(closestX, closestZ);
-        float distSq = glm::length2(playerPosXZ - closestPointXZ);
-        if (distSq < (PLAYER_RADIUS * PLAYER_RADIUS)) {
-            return true; // Collision detected
-        }
-    }
-
-    // Check against Apartment Towers (AABB collision) - Unchanged
-    for (const auto& towerBasePos : apartmentTowerPositions) {
-        float objMinX = towerBasePos.x - TOWER_WIDTH / 2.0f;
-        float objMaxX = towerBasePos.x + TOWER_WIDTH / 2.0f;
-        float objMinZ = towerBasePos.z - TOWER_DEPTH / 2.0f;
-        float objMaxZ = towerBasePos.z + TOWER_DEPTH / 2.0f;
-        float closestX = glm::clamp(playerPosXZ.x, objMinX, objMaxX);
-        float closestZ = glm::clamp(playerPosXZ.y, objMinZ, objMaxZ); // Use playerPosXZ.y for Z component
-        glm::vec2 closestPointXZ(closestX, closestZ);
-        float distSq = glm::length2(playerPosXZ - closestPointXZ);
-        if (distSq < (PLAYER_RADIUS * PLAYER_RADIUS)) {
-            return true; // Collision detected
-        }
-    }
-
-    // --- NEW: Check against Balconies (AABB collision with vertical check) --- (Unchanged)
-    for (const auto& bal : balconyData) {
-        // Define the balcony AABB in the XZ plane (using its center and dimensions)
-        float balMinX = bal.position.x - bal.dimensions.x / 2.0f;
-        float balMaxX = bal.position.x + bal.dimensions.x / 2.0f;
-        float balMinZ = bal.position.z - bal.dimensions.z / 2.0f; // Using depth for Z
-        float balMaxZ = bal.position.z + bal.dimensions.z / 2.0f;
-
-        // Find the closest point on the balcony AABB to the player's center XZ position
-        float closestX = glm::clamp(playerPosXZ.x, balMinX, balMaxX);
-        float closestZ = glm::clamp(playerPosXZ.y, balMinZ, balMaxZ); // playerPosXZ.y is player's Z
-
-        // Calculate the distance squared between the player's XZ center and this closest point
-        glm::vec2 closestPointXZ(closestX, closestZ);
-        float distSq = glm::length2(playerPosXZ - closestPointXZ);
-
-        // If the horizontal distance squared is less than the player's radius squared,
-        // then check vertical alignment.
-        if (distSq < (PLAYER_RADIUS * PLAYER_RADIUS)) {
-            // Calculate player's vertical bounds (feet and head)
-            float playerFeetY = nextPos.y - PLAYER_EYE_HEIGHT;
-            float playerHeadY = nextPos.y;
-
-            // Calculate balcony's vertical bounds (floor bottom to railing top)
-            float balconyFloorBottomY = bal.position.y - bal.dimensions.y / 2.0f;
-            // Consider railing height for the top bound
-            float balconyEffectiveTopY = bal.position.y + bal.dimensions.y / 2.0f + BALCONY_RAILING_HEIGHT;
-
-            // Check for vertical overlap:
-            // Player is overlapping if their head is above the balcony floor AND their feet are below the balcony top (including railing)
-            if (playerHeadY > balconyFloorBottomY && playerFeetY < balconyEffectiveTopY) {
-                // std::cout << "Collision with Balcony! Player Y: " << nextPos.y << " Balcony Y: " << bal.position.y << std::endl; // Debug
-                return true; // Collision detected
-            }
-        }
-    }
-
-
-    return false; // No collision
-}
-
-
-// Process keyboard input, update physics and camera position - (Unchanged)
+// Process keyboard input, update physics and camera position
+// Keys become a PlayerInput so local play and networked prediction run the same simulatePlayer().
 void processInput(GLFWwindow* window) {
     // Exit
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
 
-    // --- Speed Calculation ---
-    float currentSpeed = PLAYER_BASE_SPEED;
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-        currentSpeed *= SPRINT_MULTIPLIER;
+    PlayerInput input;
+    input.yaw = yaw;
+    input.pitch = pitch;
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) input.buttons |= BUTTON_FORWARD;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) input.buttons |= BUTTON_BACK;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) input.buttons |= BUTTON_LEFT;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) input.buttons |= BUTTON_RIGHT;
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) input.buttons |= BUTTON_JUMP;
+    if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS) input.buttons |= BUTTON_DESCEND;
+    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) input.buttons |= BUTTON_SPRINT;
+
+    if (activeNetClient) {
+        // Networked: predict at the server tick rate, render between predicted ticks
+        receiveClientPackets(*activeNetClient, glfwGetTime());
+        updateNetClient(*activeNetClient, input, deltaTime);
+        cameraPos = getPredictedEyePosition(*activeNetClient);
     }
-
-    // --- Horizontal/Forward Movement Direction ---
-    glm::vec3 moveDir(0.0f);
-    // In fly mode, use the full cameraFront vector for movement
-    // In normal mode, only use the XZ components for ground movement
-    glm::vec3 forward = g_flyModeEnabled ? cameraFront : glm::normalize(glm::vec3(cameraFront.x, 0.0f, cameraFront.z));
-    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f))); // Right is always perpendicular to world up
-
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) moveDir += forward;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) moveDir -= forward;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) moveDir -= right;
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) moveDir += right;
-
-    // Normalize moveDir if there's movement
-    if (glm::length2(moveDir) > 0.0001f) {
-        moveDir = glm::normalize(moveDir);
+    else {
+        PlayerState state;
+        state.position = cameraPos;
+        state.velocityY = cameraVelocityY;
+        state.onGround = isOnGround;
+        simulatePlayer(state, input, deltaTime, g_flyModeEnabled);
+        cameraPos = state.position;
+        cameraVelocityY = state.velocityY;
+        isOnGround = state.onGround;
     }
 
-    glm::vec3 deltaMove = moveDir * currentSpeed * deltaTime;
-
-    // --- Apply Movement & Handle Physics/Collisions based on Mode ---
-    if (g_flyModeEnabled) {
-        // --- Fly Mode ---
-        // No gravity, no ground check, no collision detection
-
-        // Apply horizontal/forward movement directly
-        cameraPos += deltaMove;
-
-        // Apply vertical movement
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) {
-            cameraPos.y += FLY_VERTICAL_SPEED * deltaTime;
-        }
-        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT_CONTROL) == GLFW_PRESS) {
-            cameraPos.y -= FLY_VERTICAL_SPEED * deltaTime;
-        }
-        isOnGround = false; // Not on ground when flying
-        cameraVelocityY = 0.0f; // Reset vertical velocity
-
+    // --- Fullscreen Toggle (F11) - Debounced --- (Unchanged)
+    bool f11Pressed = glfwGetKey(window, GLFW_KEY_F11) == GLFW_PRESS;
+    if (f11Pressed && !f11KeyPressedLastFrame) {
+        toggleFullscreen(window);
     }
-    else {
-        // --- Normal (Walk/Jump) Mode ---
-        // Apply gravity, ground check, collision detection
-
-        // Collision Detection & Resolution (Simple Slide)
-        glm::vec3 currentPos = cameraPos;
+    f11KeyPressedLastFrame = f11Pressed; // Update state for next frame
+}
 
-        // Try moving along X axis
-        glm::vec3 nextPosX = currentPos;
-        nextPosX.x += deltaMove.x; // Only change X for this check
-        if (!checkCollision(nextPosX)) { // Check collision at the potential new X position (but original Y/Z)
-            cameraPos.x = nextPosX.x; // Update camera's X if no collision
-        }
+// Chop the tree, bush or house under the crosshair, or plant the selected type where the view
+// meets the ground. Mouse buttons are debounced like F11. Edits stay local to this client.
+void processEditInput(GLFWwindow* window) {
+    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) editPlaceType = OBJECT_TREE;
+    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) editPlaceType = OBJECT_BUSH;
+    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) editPlaceType = OBJECT_HOUSE;
+
+    bool leftPressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    bool rightPressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+    bool chop = leftPressed && !leftMousePressedLastFrame;
+    bool plant = rightPressed && !rightMousePressedLastFrame;
+    leftMousePressedLastFrame = leftPressed;
+    rightMousePressedLastFrame = rightPressed;
+    if (!chop && !plant) return;
+    if (activeNetClient) {
+        // The server's world would disagree with ours about collisions
+        std::cout << "World editing is disabled while connected to a server" << std::endl;
+        return;
+    }
 
-        // Try moving along Z axis
-        // Use the potentially updated X position from the previous step
-        glm::vec3 nextPosZ = cameraPos; // Start from current camera pos (which might have updated X)
-        nextPosZ.z += deltaMove.z; // Only change Z for this check
-        if (!checkCollision(nextPosZ)) { // Check collision at the potential new Z position (with potentially updated X, original Y)
-            cameraPos.z = nextPosZ.z; // Update camera's Z if no collision
+    if (chop) {
+        WorldObjectType type;
+        size_t index;
+        if (pickWorldObject(cameraPos, cameraFront, EDIT_REACH, &type, &index)) {
+            removeInstancedObject(worldInstances, type, index);
         }
-
-        // --- Vertical Movement (Gravity & Jump) ---
-        // Apply gravity
-        cameraVelocityY -= GRAVITY * deltaTime;
-
-        // Jump
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && isOnGround) {
-            cameraVelocityY = JUMP_FORCE;
-            isOnGround = false; // Prevent holding space for continuous jumping
+    }
+    if (plant && cameraFront.y < 0.0f) {
+        float distance = (GROUND_LEVEL - cameraPos.y) / cameraFront.y;
+        if (distance <= EDIT_REACH) {
+            glm::vec3 basePosition = cameraPos + cameraFront * distance;
+            basePosition.y = GROUND_LEVEL;
+            size_t index = placeInstancedObject(worldInstances, editPlaceType, basePosition);
+            // Don't trap the player inside what was just planted
+            if (!g_flyModeEnabled && checkCollision(cameraPos)) {
+                removeInstancedObject(worldInstances, editPlaceType, index);
+            }
         }
+    }
+}
 
-        // Update vertical position
-        glm::vec3 nextPosY = cameraPos; // Start from current position (potentially updated X/Z)
-        nextPosY.y += cameraVelocityY * deltaTime; // Calculate potential new Y
-
-        // Ground collision check (before applying vertical movement)
-        float playerFeetY = nextPosY.y - PLAYER_EYE_HEIGHT;
-        if (playerFeetY <= GROUND_LEVEL) {
-            cameraPos.y = GROUND_LEVEL + PLAYER_EYE_HEIGHT; // Snap to ground
-            cameraVelocityY = 0.0f; // Stop falling
-            isOnGround = true;      // Allow jumping again
-        }
-        else {
-            // If not hitting the ground, apply the calculated vertical movement
-            cameraPos.y = nextPosY.y;
-            isOnGround = false; // Player is in the air
+// Live-tweak the generation parameters. Only the selected category (plus balconies, when the
+// towers change) is regenerated, so everything else keeps its objects and player edits.
+void processGenerationInput(GLFWwindow* window) {
+    const int selectKeys[GEN_NODE_COUNT] = { GLFW_KEY_F1, GLFW_KEY_F2, GLFW_KEY_F3, GLFW_KEY_F4, GLFW_KEY_F5 };
+    for (int node = 0; node < GEN_NODE_COUNT; ++node) {
+        if (glfwGetKey(window, selectKeys[node]) == GLFW_PRESS && tweakNode != node) {
+            tweakNode = static_cast<WorldGenNode>(node);
+            std::cout << "Tweaking " << WORLD_GEN_NODES[node].name << ": " << getWorldGenCount(worldGenParams, tweakNode) << std::endl;
         }
     }
 
-
-    // --- Fullscreen Toggle (F11) - Debounced --- (Unchanged)
-    bool f11Pressed = glfwGetKey(window, GLFW_KEY_F11) == GLFW_PRESS;
-    if (f11Pressed && !f11KeyPressedLastFrame) {
-        toggleFullscreen(window);
+    bool more = glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_KP_ADD) == GLFW_PRESS;
+    bool less = glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_KP_SUBTRACT) == GLFW_PRESS;
+    bool reroll = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+    bool pressed = more || less || reroll;
+    bool triggered = pressed && !tweakKeysPressedLastFrame;
+    tweakKeysPressedLastFrame = pressed;
+    if (!triggered) return;
+    if (activeNetClient) {
+        std::cout << "World generation is fixed while connected to a server" << std::endl;
+        return;
     }
-    f11KeyPressedLastFrame = f11Pressed; // Update state for next frame
+
+    int& count = getWorldGenCount(worldGenParams, tweakNode);
+    if (more) count += GEN_TWEAK_STEPS[tweakNode];
+    if (less) count = std::max(0, count - GEN_TWEAK_STEPS[tweakNode]);
+    if (reroll) worldGenParams.variation[tweakNode]++;
 }
 
-// GLFW framebuffer size callback (Unchanged)
+// GLFW framebuffer size callback
+// The dynamic resolution target follows on the next frame: beginDynamicResolutionFrame()
+// compares against the framebuffer size and reallocates, then resets the viewport itself.
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
     glViewport(0, 0, width, height);
 }
@@ -692,19 +847,7 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     float xoffset = xpos - lastX;
     float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
     lastX = xpos; lastY = ypos;
-    float sensitivity = 0.1f;
-    xoffset *= sensitivity; yoffset *= sensitivity;
-    yaw += xoffset; pitch += yoffset;
-    if (pitch > 89.0f) pitch = 89.0f; if (pitch < -89.0f) pitch = -89.0f;
-    glm::vec3 front;
-    front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-    front.y = sin(glm::radians(pitch));
-    front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-    cameraFront = glm::normalize(front);
-    // Recalculate cameraUp to prevent roll issues, especially in fly mode
-    glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
-    glm::vec3 cameraRight = glm::normalize(glm::cross(cameraFront, worldUp));
-    cameraUp = glm::normalize(glm::cross(cameraRight, cameraFront));
+    applyMouseLook(xoffset, yoffset, yaw, pitch, cameraFront, cameraUp);
 }
 
 // Compile Shader (Unchanged)
@@ -739,100 +882,233 @@ unsigned int createShaderProgram(const char* vertexSource, const char* fragmentS
     return shaderProgram;
 }
 
-// Generate Object Positions (Generic version, used for trees, bushes, houses) - Unchanged
-void generateObjectPositions(std::vector<glm::vec3>& positions, float areaSize, int count) {
-    float halfSize = areaSize / 2.0f;
-    positions.clear();
-    positions.reserve(count);
-    for (int i = 0; i < count; ++i) {
-        float x = (static_cast<float>(rand()) / RAND_MAX) * areaSize - halfSize;
-        float z = (static_cast<float>(rand()) / RAND_MAX) * areaSize - halfSize;
-        positions.push_back(glm::vec3(x, GROUND_LEVEL, z));
+static DrawInstance makeDrawInstance(const WorldPart& part, bool alive) {
+    return { getWorldPartModelMatrix(part), WORLD_PART_COLORS[part.type], part.type, alive };
+}
+
+// Build the per-part model matrices and colors for every instance slot.
+// Called once after generation; both render paths consume the result.
+void buildDrawList(DrawList& list, const WorldInstances& instances) {
+    resetArenaVector(list, instances.parts.size());
+    for (size_t slot = 0; slot < instances.parts.size(); ++slot) {
+        list.push_back(makeDrawInstance(instances.parts[slot], instances.alive[slot] != 0));
     }
 }
 
-// --- NEW: Generate Towers and Balconies --- (Unchanged)
-void generateTowersAndBalconies(float areaSize, int towerCount, int balconiesPerTower) {
-    float halfSize = areaSize / 2.0f;
-    apartmentTowerPositions.clear();
-    apartmentTowerPositions.reserve(towerCount);
-    balconyData.clear();
-    balconyData.reserve(towerCount * balconiesPerTower); // Reserve space
-
-    for (int i = 0; i < towerCount; ++i) {
-        // --- Generate Tower Position ---
-        float towerX = (static_cast<float>(rand()) / RAND_MAX) * areaSize - halfSize;
-        float towerZ = (static_cast<float>(rand()) / RAND_MAX) * areaSize - halfSize;
-        glm::vec3 towerBasePos = glm::vec3(towerX, GROUND_LEVEL, towerZ);
-        apartmentTowerPositions.push_back(towerBasePos);
-
-        // --- Generate Balconies for this Tower ---
-        for (int j = 0; j < balconiesPerTower; ++j) {
-            Balcony bal;
-
-            // Determine balcony height (distribute somewhat evenly, avoiding very top/bottom)
-            float heightFraction = (static_cast<float>(j + 1) / (balconiesPerTower + 1));
-            float balconyY = towerBasePos.y + TOWER_HEIGHT * heightFraction; // Center Y of the balcony floor
-
-            // Determine which side the balcony is on (randomly)
-            int side = rand() % 4; // 0: +Z, 1: -Z, 2: +X, 3: -X
-            float balconyX = towerX;
-            float balconyZ = towerZ;
-            float railingOffsetX = BALCONY_WIDTH / 2.0f - BALCONY_RAILING_THICKNESS / 2.0f;
-            float railingOffsetZ = BALCONY_DEPTH / 2.0f - BALCONY_RAILING_THICKNESS / 2.0f;
-            float railingOffsetY = BALCONY_FLOOR_HEIGHT / 2.0f + BALCONY_RAILING_HEIGHT / 2.0f;
-
-            bal.dimensions = glm::vec3(BALCONY_WIDTH, BALCONY_FLOOR_HEIGHT, BALCONY_DEPTH);
-            bal.railingDimsFront = glm::vec3(BALCONY_WIDTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS);
-            bal.railingDimsSide = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_DEPTH);
-
-
-            if (side == 0) { // Front (+Z)
-                balconyZ += TOWER_DEPTH / 2.0f + BALCONY_DEPTH / 2.0f;
-                bal.railingFrontPosRel = glm::vec3(0.0f, railingOffsetY, railingOffsetZ);
-                bal.railingLeftPosRel = glm::vec3(-railingOffsetX, railingOffsetY, 0.0f);
-                bal.railingRightPosRel = glm::vec3(railingOffsetX, railingOffsetY, 0.0f);
-            }
-            else if (side == 1) { // Back (-Z)
-                balconyZ -= TOWER_DEPTH / 2.0f + BALCONY_DEPTH / 2.0f;
-                bal.railingFrontPosRel = glm::vec3(0.0f, railingOffsetY, -railingOffsetZ); // Back railing
-                bal.railingLeftPosRel = glm::vec3(-railingOffsetX, railingOffsetY, 0.0f);
-                bal.railingRightPosRel = glm::vec3(railingOffsetX, railingOffsetY, 0.0f);
-                // Swap side railing dims W/D
-                bal.railingDimsFront = glm::vec3(BALCONY_WIDTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS);
-                bal.railingDimsSide = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_DEPTH);
-            }
-            else if (side == 2) { // Right (+X)
-                balconyX += TOWER_WIDTH / 2.0f + BALCONY_DEPTH / 2.0f; // Use depth for offset along X
-                bal.dimensions = glm::vec3(BALCONY_DEPTH, BALCONY_FLOOR_HEIGHT, BALCONY_WIDTH); // Swap W/D for dimensions
-                bal.railingFrontPosRel = glm::vec3(railingOffsetZ, railingOffsetY, 0.0f); // Use Z offset for X direction railing
-                bal.railingLeftPosRel = glm::vec3(0.0f, railingOffsetY, -railingOffsetX); // Use X offset for Z direction railing
-                bal.railingRightPosRel = glm::vec3(0.0f, railingOffsetY, railingOffsetX); // Use X offset for Z direction railing
-                // Swap railing dims
-                bal.railingDimsFront = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_WIDTH); // Thickness, Height, Width(as depth)
-                bal.railingDimsSide = glm::vec3(BALCONY_DEPTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS); // Depth(as width), Height, Thickness
+// Rewrite the dirty slots after edits; returns how many were rewritten.
+size_t updateDrawList(DrawList& list, const WorldInstances& instances, const std::vector<InstanceRange>& ranges) {
+    list.resize(instances.parts.size());
+    size_t slots = 0;
+    for (const InstanceRange& range : ranges) {
+        for (uint32_t slot = range.first; slot < range.first + range.count; ++slot) {
+            list[slot] = makeDrawInstance(instances.parts[slot], instances.alive[slot] != 0);
+        }
+        slots += range.count;
+    }
+    return slots;
+}
 
-            }
-            else { // Left (-X)
-                balconyX -= TOWER_WIDTH / 2.0f + BALCONY_DEPTH / 2.0f; // Use depth for offset along X
-                bal.dimensions = glm::vec3(BALCONY_DEPTH, BALCONY_FLOOR_HEIGHT, BALCONY_WIDTH); // Swap W/D for dimensions
-                bal.railingFrontPosRel = glm::vec3(-railingOffsetZ, railingOffsetY, 0.0f); // Use Z offset for X direction railing
-                bal.railingLeftPosRel = glm::vec3(0.0f, railingOffsetY, -railingOffsetX); // Use X offset for Z direction railing
-                bal.railingRightPosRel = glm::vec3(0.0f, railingOffsetY, railingOffsetX); // Use X offset for Z direction railing
-                // Swap railing dims
-                bal.railingDimsFront = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_WIDTH); // Thickness, Height, Width(as depth)
-                bal.railingDimsSide = glm::vec3(BALCONY_DEPTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS); // Depth(as width), Height, Thickness
-            }
+// Create Compute Program (GL 4.3+)
+unsigned int createComputeProgram(const char* computeSource) {
+    unsigned int computeShader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(computeShader, 1, &computeSource, NULL);
+    glCompileShader(computeShader);
+    int success; char infoLog[512];
+    glGetShaderiv(computeShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(computeShader, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::COMPUTE::COMPILATION_FAILED\n" << infoLog << std::endl;
+        glDeleteShader(computeShader); return 0;
+    }
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, computeShader); glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        glDeleteProgram(program); program = 0;
+    }
+    glDeleteShader(computeShader);
+    return program;
+}
 
+// World AABB of the transformed unit cube, batch index packed into boundsCenter.w
+static GpuObject makeGpuObject(const DrawInstance& inst) {
+    GpuObject obj;
+    obj.model = inst.model;
+    obj.color = glm::vec4(inst.color, 1.0f);
+    glm::vec3 extent(0.0f);
+    for (int axis = 0; axis < 3; ++axis) {
+        extent[axis] = 0.5f * (std::abs(inst.model[0][axis]) + std::abs(inst.model[1][axis]) + std::abs(inst.model[2][axis]));
+    }
+    obj.boundsCenter = glm::vec4(glm::vec3(inst.model[3]), static_cast<float>(inst.batch));
+    obj.boundsExtent = glm::vec4(extent, inst.alive ? 1.0f : 0.0f);
+    return obj;
+}
 
-            bal.position = glm::vec3(balconyX, balconyY, balconyZ);
-            balconyData.push_back(bal);
-            // std::cout << "Generated Balcony at: " << glm::to_string(bal.position) << std::endl; // Debug
+// Each batch owns a contiguous range of the visible list starting at its baseInstance. When a
+// batch outgrows its range every base moves and the list is reallocated; it is rewritten by
+// the cull pass each frame, so nothing needs copying.
+static void reserveVisibleRanges(GpuCuller& culler, const size_t* liveCountByType) {
+    bool relayout = culler.commandTemplate.empty();
+    for (int b = 0; b < PART_COUNT; ++b) {
+        if (liveCountByType[b] > culler.batchCapacity[b]) {
+            culler.batchCapacity[b] = static_cast<GLuint>(std::max<size_t>(liveCountByType[b] * 3 / 2, 64));
+            relayout = true;
         }
     }
-    std::cout << "Generated " << apartmentTowerPositions.size() << " towers and " << balconyData.size() << " balconies." << std::endl;
+    if (!relayout) return;
+
+    culler.commandTemplate.resize(PART_COUNT);
+    GLuint base = 0;
+    for (int b = 0; b < PART_COUNT; ++b) {
+        culler.commandTemplate[b] = { 36, 0, 0, base };
+        base += culler.batchCapacity[b];
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.visibleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, base * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Writes list[first, first + count) to the bound object buffer through `staging`, which holds
+// GPU_UPLOAD_CHUNK objects, so even a full upload needs only a small scratch allocation
+static size_t uploadGpuObjects(const DrawList& list, uint32_t first, uint32_t count, GpuObject* staging) {
+    for (uint32_t start = first; start < first + count; start += GPU_UPLOAD_CHUNK) {
+        uint32_t chunk = std::min(GPU_UPLOAD_CHUNK, first + count - start);
+        for (uint32_t i = 0; i < chunk; ++i) staging[i] = makeGpuObject(list[start + i]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, start * sizeof(GpuObject), chunk * sizeof(GpuObject), staging);
+    }
+    return count * sizeof(GpuObject);
+}
+
+// Upload all object bounds/matrices to the GPU and prepare one indirect command per batch.
+// Returns false (leaving nothing allocated) if any shader fails, so the caller can fall back.
+bool initGpuCuller(GpuCuller& culler, unsigned int cubeVBO, const DrawList& list, const size_t* liveCountByType, Arena& scratch) {
+    culler.cullProgram = createComputeProgram(cullComputeShaderSource);
+    culler.drawProgram = createShaderProgram(indirectVertexShaderSource, indirectFragmentShaderSource);
+    if (culler.cullProgram == 0 || culler.drawProgram == 0) {
+        if (culler.cullProgram) glDeleteProgram(culler.cullProgram);
+        if (culler.drawProgram) glDeleteProgram(culler.drawProgram);
+        culler.cullProgram = culler.drawProgram = 0;
+        return false;
+    }
+
+    // Objects, with headroom for planted ones; edits upload only their dirty ranges
+    culler.objectCount = static_cast<GLuint>(list.size());
+    culler.objectCapacity = std::max<GLuint>(culler.objectCount + culler.objectCount / 4, 64);
+
+    glGenBuffers(1, &culler.objectBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.objectBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, culler.objectCapacity * sizeof(GpuObject), NULL, GL_DYNAMIC_DRAW);
+    uploadGpuObjects(list, 0, culler.objectCount, arenaAllocateArray<GpuObject>(scratch, GPU_UPLOAD_CHUNK));
+
+    glGenBuffers(1, &culler.visibleBuffer);
+    reserveVisibleRanges(culler, liveCountByType);
+
+    glGenBuffers(1, &culler.commandBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, culler.commandTemplate.size() * sizeof(DrawArraysIndirectCommand), culler.commandTemplate.data(), GL_DYNAMIC_DRAW);
+
+    // Filled by setGpuCullerPvs(); a binding needs a buffer behind it even while unused
+    glGenBuffers(1, &culler.pvsBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.pvsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Cube positions at location 0, visible object index per instance at location 1
+    glGenVertexArrays(1, &culler.VAO);
+    glBindVertexArray(culler.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, culler.visibleBuffer);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return true;
 }
 
+// Upload the dirty slot ranges after edits; returns the bytes sent. Running out of capacity
+// doubles the buffer and uploads everything once, amortized over the edits that filled it.
+size_t updateGpuCuller(GpuCuller& culler, const DrawList& list, const size_t* liveCountByType, const std::vector<InstanceRange>& ranges, Arena& scratch) {
+    reserveVisibleRanges(culler, liveCountByType);
+    culler.objectCount = static_cast<GLuint>(list.size());
+
+    GpuObject* staging = arenaAllocateArray<GpuObject>(scratch, GPU_UPLOAD_CHUNK);
+    size_t bytes = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.objectBuffer);
+    if (culler.objectCount > culler.objectCapacity) {
+        while (culler.objectCapacity < culler.objectCount) culler.objectCapacity *= 2;
+        glBufferData(GL_SHADER_STORAGE_BUFFER, culler.objectCapacity * sizeof(GpuObject), NULL, GL_DYNAMIC_DRAW);
+        bytes = uploadGpuObjects(list, 0, culler.objectCount, staging);
+    }
+    else {
+        for (const InstanceRange& range : ranges) bytes += uploadGpuObjects(list, range.first, range.count, staging);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return bytes;
+}
+
+// Uploads the player's cell set, or turns the PVS test off when there is none. Called only when
+// the player changes cells or edits the world, so the set is sent a few times a minute at most.
+void setGpuCullerPvs(GpuCuller& culler, const PvsState& pvs) {
+    culler.usePvs = pvs.cell >= 0;
+    if (!culler.usePvs) return;
+    // Little-endian uint64 words read as uint32 pairs keep the bit order the shader expects
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.pvsBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, pvs.visible.size() * sizeof(uint64_t), pvs.visible.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Cull on the GPU and submit the whole frame with a single glMultiDrawArraysIndirect
+void drawWithGpuCulling(const GpuCuller& culler, const glm::mat4& projection, const glm::mat4& view) {
+    // Frustum planes from the view-projection rows (Gribb/Hartmann); unnormalized is fine for the sign test
+    glm::mat4 viewProj = projection * view;
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i) row[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+    glm::vec4 planes[6] = {
+        row[3] + row[0], row[3] - row[0], // left, right
+        row[3] + row[1], row[3] - row[1], // bottom, top
+        row[3] + row[2], row[3] - row[2]  // near, far
+    };
+
+    // Reset instance counts, then let the compute pass fill them
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, culler.commandBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, culler.commandTemplate.size() * sizeof(DrawArraysIndirectCommand), culler.commandTemplate.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glUseProgram(culler.cullProgram);
+    glUniform4fv(glGetUniformLocation(culler.cullProgram, "frustumPlanes"), 6, glm::value_ptr(planes[0]));
+    glUniform1ui(glGetUniformLocation(culler.cullProgram, "objectCount"), culler.objectCount);
+    glUniform1i(glGetUniformLocation(culler.cullProgram, "usePvs"), culler.usePvs ? 1 : 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, culler.objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, culler.commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, culler.visibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, culler.pvsBuffer);
+    glDispatchCompute((culler.objectCount + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glUseProgram(culler.drawProgram);
+    glUniformMatrix4fv(glGetUniformLocation(culler.drawProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(glGetUniformLocation(culler.drawProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    glBindVertexArray(culler.VAO);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culler.commandBuffer);
+    glMultiDrawArraysIndirect(GL_TRIANGLES, (void*)0, PART_COUNT, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void destroyGpuCuller(GpuCuller& culler) {
+    glDeleteVertexArrays(1, &culler.VAO);
+    glDeleteBuffers(1, &culler.objectBuffer);
+    glDeleteBuffers(1, &culler.commandBuffer);
+    glDeleteBuffers(1, &culler.visibleBuffer);
+    glDeleteBuffers(1, &culler.pvsBuffer);
+    glDeleteProgram(culler.cullProgram);
+    glDeleteProgram(culler.drawProgram);
+    culler = GpuCuller();
+}
 
 // --- Win32 Specific Functions --- (Unchanged)
 #ifdef _WIN32
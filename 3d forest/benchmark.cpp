@@ -0,0 +1,197 @@
+#include "benchmark.h"
+
+#include "player.h"
+#include "world.h"
+#include "world_graph.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Keeps results alive so the optimizer can't drop the work being timed
+static volatile float benchmarkSink = 0.0f;
+
+// Calls op() until minSeconds have passed (at least once) and records the average
+template <typename Op>
+static void measure(const BenchmarkOptions& options, const char* name, size_t size, size_t itemsPerOp, Op op,
+                    std::vector<BenchmarkResult>& results) {
+    if (!options.filter.empty() && std::strstr(name, options.filter.c_str()) == NULL) return;
+    op(); // Warm caches and lazily built structures
+    size_t iterations = 0;
+    double elapsed = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    do {
+        op();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < options.minSeconds);
+
+    BenchmarkResult result;
+    result.name = name;
+    result.size = size;
+    result.iterations = iterations;
+    result.itemsPerOp = itemsPerOp;
+    result.nsPerOp = elapsed * 1e9 / iterations;
+    result.nsPerItem = result.nsPerOp / itemsPerOp;
+    results.push_back(result);
+}
+
+void runMicroBenchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results) {
+    // Query positions too come from a portable stream, so runs compare across platforms
+    WorldRandom queryRandom = makeWorldRandom(options.seed, SEED_STREAM_QUERIES);
+
+    // --- Generation ---
+    const int positionCounts[] = { 100, 1000, 10000, 100000 };
+    Arena positionArena(MEMORY_WORLD);
+    WorldPositions positions((ArenaAllocator<glm::vec3>(&positionArena)));
+    WorldRandom random = makeWorldRandom(options.seed, SEED_STREAM_TREES);
+    for (int count : positionCounts) {
+        float area = GROUND_SIZE * std::sqrt(count / static_cast<float>(TREE_COUNT));
+        measure(options, "generate_object_positions", count, count, [&]() {
+            generateObjectPositions(positions, area, count, random);
+            benchmarkSink = benchmarkSink + positions.back().x;
+        }, results);
+    }
+    const int towerCounts[] = { 25, 250, 2500 };
+    Arena balconyArena(MEMORY_WORLD);
+    ArenaVector<Balcony> balconies((ArenaAllocator<Balcony>(&balconyArena)));
+    for (int count : towerCounts) {
+        float area = GROUND_SIZE * std::sqrt(count / static_cast<float>(APARTMENT_TOWER_COUNT));
+        measure(options, "generate_towers_and_balconies", count, count, [&]() {
+            WorldRandom towers = makeWorldRandom(options.seed, SEED_STREAM_TOWERS);
+            generateObjectPositions(positions, area, count, towers);
+            generateBalconies(balconies, positions, BALCONIES_PER_TOWER, makeWorldRandom(options.seed, SEED_STREAM_BALCONIES));
+            benchmarkSink = benchmarkSink + balconies.back().position.y;
+        }, results);
+    }
+
+    // --- Generation Graph (a whole world vs. one tweaked count) ---
+    const int graphScales[] = { 1, 10 };
+    for (int scale : graphScales) {
+        WorldGenParams params = makeScaledWorldGenParams(options.seed, scale);
+        size_t objects = params.treeCount + params.bushCount + params.houseCount + params.towerCount * (1 + params.balconiesPerTower);
+        measure(options, "world_graph_full", scale, objects, [&]() {
+            WorldGenGraph graph;
+            updateWorldGraph(graph, params);
+            benchmarkSink = benchmarkSink + treePositions.back().x;
+        }, results);
+
+        // Alternates between two values, so every call regenerates just the one node
+        WorldGenGraph graph;
+        updateWorldGraph(graph, params);
+        WorldGenParams tweaked = params;
+        measure(options, "world_graph_tree_count", scale, params.treeCount, [&]() {
+            tweaked.treeCount = tweaked.treeCount == params.treeCount ? params.treeCount + 1 : params.treeCount;
+            benchmarkSink = benchmarkSink + static_cast<float>(updateWorldGraph(graph, tweaked));
+        }, results);
+        measure(options, "world_graph_balconies_per_tower", scale, params.towerCount * params.balconiesPerTower, [&]() {
+            tweaked.balconiesPerTower = tweaked.balconiesPerTower == params.balconiesPerTower ? params.balconiesPerTower + 1 : params.balconiesPerTower;
+            benchmarkSink = benchmarkSink + static_cast<float>(updateWorldGraph(graph, tweaked));
+        }, results);
+    }
+
+    // --- Collision (random eye positions over the whole world, walk-mode height) ---
+    const int worldScales[] = { 1, 10, 100 };
+    const size_t COLLISION_QUERIES = 10000;
+    std::vector<glm::vec3> queries(COLLISION_QUERIES);
+    for (int scale : worldScales) {
+        generateScaledWorld(options.seed, scale);
+        float area = getScaledAreaSize(scale);
+        for (glm::vec3& q : queries) q = randomAreaPoint(queryRandom, area, GROUND_LEVEL + PLAYER_EYE_HEIGHT);
+        measure(options, "check_collision", scale, COLLISION_QUERIES, [&]() {
+            int hits = 0;
+            for (const glm::vec3& q : queries) hits += checkCollision(q);
+            benchmarkSink = benchmarkSink + static_cast<float>(hits);
+        }, results);
+    }
+
+    // --- Model Matrices (what buildDrawList does for every part) ---
+    std::vector<WorldPart> parts;
+    const int matrixScales[] = { 1, 10 };
+    for (int scale : matrixScales) {
+        generateScaledWorld(options.seed, scale);
+        parts.resize(countWorldParts());
+        getWorldParts(0, parts.size(), parts.data());
+        measure(options, "build_model_matrices", scale, parts.size(), [&]() {
+            float sum = 0.0f;
+            for (const WorldPart& part : parts) sum += getWorldPartModelMatrix(part)[3][0];
+            benchmarkSink = benchmarkSink + sum;
+        }, results);
+    }
+
+    // --- Mouse Look (one mouse_callback per cursor event) ---
+    const size_t MOUSE_EVENTS = 10000;
+    std::vector<glm::vec2> offsets(MOUSE_EVENTS);
+    for (glm::vec2& o : offsets) {
+        glm::vec3 p = randomAreaPoint(queryRandom, 40.0f, 0.0f);
+        o = glm::vec2(p.x, p.z);
+    }
+    measure(options, "mouse_look", 1, MOUSE_EVENTS, [&]() {
+        float yaw = -90.0f, pitch = 0.0f;
+        glm::vec3 front, up;
+        for (const glm::vec2& o : offsets) applyMouseLook(o.x, o.y, yaw, pitch, front, up);
+        benchmarkSink = benchmarkSink + front.x + up.y;
+    }, results);
+}
+
+void writeBenchmarkResults(std::ostream& out, const std::vector<BenchmarkResult>& results, BenchmarkFormat format) {
+    std::streamsize oldPrecision = out.precision(6);
+    if (format == BENCHMARK_CSV) {
+        out << "name,size,iterations,items_per_op,ns_per_op,ns_per_item\n";
+        for (const BenchmarkResult& r : results) {
+            out << r.name << ',' << r.size << ',' << r.iterations << ',' << r.itemsPerOp << ',' << r.nsPerOp << ',' << r.nsPerItem << '\n';
+        }
+    }
+    else {
+        out << "{\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchmarkResult& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"iterations\": " << r.iterations
+                << ", \"items_per_op\": " << r.itemsPerOp << ", \"ns_per_op\": " << r.nsPerOp << ", \"ns_per_item\": " << r.nsPerItem
+                << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+    out.precision(oldPrecision);
+    out.flush();
+}
+
+int runMicroBenchmarkCommand(int argc, char** argv) {
+    BenchmarkOptions options;
+    BenchmarkFormat format = BENCHMARK_JSON;
+    std::string outPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "csv") format = BENCHMARK_CSV;
+            else if (value != "json") {
+                std::cerr << "ERROR::BENCHMARK::UNKNOWN_FORMAT " << value << std::endl;
+                return -1;
+            }
+        }
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--min-time" && hasValue) options.minSeconds = std::strtod(argv[++i], NULL);
+        else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--seed" && hasValue) options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], NULL, 10));
+    }
+
+    std::vector<BenchmarkResult> results;
+    runMicroBenchmarks(options, results);
+    if (outPath.empty()) {
+        writeBenchmarkResults(std::cout, results, format);
+        return 0;
+    }
+    std::ofstream file(outPath.c_str());
+    if (!file) {
+        std::cerr << "ERROR::BENCHMARK::CANNOT_OPEN " << outPath << std::endl;
+        return -1;
+    }
+    writeBenchmarkResults(file, results, format);
+    return 0;
+}
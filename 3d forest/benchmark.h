@@ -0,0 +1,39 @@
+// Headless micro-benchmarks of the world generation, collision and per-frame CPU routines.
+// No window or GL context is needed; results are written as JSON or CSV, one record per case,
+// so runs from different commits can be compared by script.
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --- Benchmark Configuration ---
+const double BENCHMARK_DEFAULT_MIN_SECONDS = 0.25; // Each case repeats until it has run this long
+
+enum BenchmarkFormat {
+    BENCHMARK_JSON,
+    BENCHMARK_CSV
+};
+
+struct BenchmarkResult {
+    std::string name;        // Routine under test
+    size_t size = 0;         // Case parameter: object count or world scale
+    size_t iterations = 0;   // Timed calls
+    size_t itemsPerOp = 1;   // Objects, queries or matrices handled per call
+    double nsPerOp = 0.0;
+    double nsPerItem = 0.0;
+};
+
+struct BenchmarkOptions {
+    double minSeconds = BENCHMARK_DEFAULT_MIN_SECONDS;
+    std::string filter;      // Only cases whose name contains this
+    unsigned int seed = 1;
+};
+
+// Runs every case matching options.filter. Regenerates the world globals as it goes.
+void runMicroBenchmarks(const BenchmarkOptions& options, std::vector<BenchmarkResult>& results);
+void writeBenchmarkResults(std::ostream& out, const std::vector<BenchmarkResult>& results, BenchmarkFormat format);
+// Command line front end shared by the forest_bench target and --microbench:
+// [--format json|csv] [--out file] [--min-time seconds] [--filter name] [--seed N]
+int runMicroBenchmarkCommand(int argc, char** argv);
@@ -0,0 +1,131 @@
+#include <glad/glad.h>
+#include "dynamic_resolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool initDynamicResolution(DynamicResolution& drs, const DynamicResolutionSettings& settings) {
+    drs = DynamicResolution();
+    drs.settings = settings;
+    drs.settings.minScale = std::max(DRS_SCALE_STEP, std::min(settings.minScale, settings.maxScale));
+    drs.settings.maxScale = std::max(drs.settings.minScale, settings.maxScale);
+    drs.scale = drs.settings.maxScale;
+    glGenFramebuffers(1, &drs.FBO);
+    glGenRenderbuffers(1, &drs.colorRenderbuffer);
+    glGenRenderbuffers(1, &drs.depthRenderbuffer);
+    glGenQueries(DRS_QUERY_COUNT, drs.queries);
+    return true;
+}
+
+// Size the render target for the largest allowed scale so scale changes only move the viewport
+static bool allocateTargets(DynamicResolution& drs, int windowWidth, int windowHeight) {
+    drs.windowWidth = windowWidth;
+    drs.windowHeight = windowHeight;
+    drs.targetWidth = std::max(1, static_cast<int>(std::ceil(windowWidth * drs.settings.maxScale)));
+    drs.targetHeight = std::max(1, static_cast<int>(std::ceil(windowHeight * drs.settings.maxScale)));
+
+    glBindRenderbuffer(GL_RENDERBUFFER, drs.colorRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, drs.targetWidth, drs.targetHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, drs.depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, drs.targetWidth, drs.targetHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, drs.FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, drs.colorRenderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, drs.depthRenderbuffer);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete) {
+        std::cerr << "ERROR::FRAMEBUFFER::DYNAMIC_RESOLUTION_TARGET_INCOMPLETE" << std::endl;
+        return false;
+    }
+
+    // Timings of the old size no longer describe the new one
+    drs.smoothedGpuMs = 0.0f;
+    drs.samplesSinceChange = 0;
+    drs.resizeGeneration++;
+    return true;
+}
+
+bool beginDynamicResolutionFrame(DynamicResolution& drs, int windowWidth, int windowHeight) {
+    if (windowWidth <= 0 || windowHeight <= 0) return false;
+    if (windowWidth != drs.windowWidth || windowHeight != drs.windowHeight) {
+        if (!allocateTargets(drs, windowWidth, windowHeight)) return false;
+    }
+
+    drs.renderWidth = std::min(drs.targetWidth, std::max(1, static_cast<int>(std::lround(windowWidth * drs.scale))));
+    drs.renderHeight = std::min(drs.targetHeight, std::max(1, static_cast<int>(std::lround(windowHeight * drs.scale))));
+    glBindFramebuffer(GL_FRAMEBUFFER, drs.FBO);
+    glViewport(0, 0, drs.renderWidth, drs.renderHeight);
+
+    // Reuse the oldest query slot; skip timing this frame if it hasn't been collected yet
+    int slot = drs.frameIndex % DRS_QUERY_COUNT;
+    if (!drs.queryPending[slot]) {
+        glBeginQuery(GL_TIME_ELAPSED, drs.queries[slot]);
+    }
+    return true;
+}
+
+// Non-blocking: pick up every query whose result has landed
+static void collectTimings(DynamicResolution& drs) {
+    for (int i = 0; i < DRS_QUERY_COUNT; ++i) {
+        if (!drs.queryPending[i]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(drs.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(drs.queries[i], GL_QUERY_RESULT, &elapsedNs);
+        drs.queryPending[i] = false;
+        if (drs.queryGeneration[i] != drs.resizeGeneration) continue;
+
+        float sampleMs = static_cast<float>(elapsedNs) / 1.0e6f;
+        drs.smoothedGpuMs = (drs.smoothedGpuMs <= 0.0f) ? sampleMs : drs.smoothedGpuMs + (sampleMs - drs.smoothedGpuMs) * DRS_SMOOTHING;
+        if (++drs.samplesSinceChange < DRS_SETTLE_SAMPLES) continue;
+        float nextScale = computeResolutionScale(drs.scale, drs.smoothedGpuMs, drs.settings);
+        if (nextScale != drs.scale) {
+            drs.scale = nextScale;
+            drs.samplesSinceChange = 0;
+        }
+    }
+}
+
+void endDynamicResolutionFrame(DynamicResolution& drs) {
+    int slot = drs.frameIndex % DRS_QUERY_COUNT;
+    if (!drs.queryPending[slot]) {
+        glEndQuery(GL_TIME_ELAPSED);
+        drs.queryPending[slot] = true;
+        drs.queryGeneration[slot] = drs.resizeGeneration;
+    }
+    drs.frameIndex++;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, drs.FBO);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, drs.renderWidth, drs.renderHeight, 0, 0, drs.windowWidth, drs.windowHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, drs.windowWidth, drs.windowHeight);
+
+    collectTimings(drs);
+}
+
+void destroyDynamicResolution(DynamicResolution& drs) {
+    glDeleteQueries(DRS_QUERY_COUNT, drs.queries);
+    glDeleteFramebuffers(1, &drs.FBO);
+    glDeleteRenderbuffers(1, &drs.colorRenderbuffer);
+    glDeleteRenderbuffers(1, &drs.depthRenderbuffer);
+    drs = DynamicResolution();
+}
+
+// GPU cost follows pixel count, i.e. scale squared, so the ideal scale is scale * sqrt(target / time).
+// Moving only part of the way there, ignoring small errors and snapping to steps keeps it from oscillating.
+float computeResolutionScale(float scale, float smoothedGpuMs, const DynamicResolutionSettings& settings) {
+    if (smoothedGpuMs <= 0.0f) return scale;
+    float ratio = settings.targetFrameMs / smoothedGpuMs;
+    if (ratio > 1.0f - DRS_DEADBAND && ratio < 1.0f + DRS_DEADBAND) return scale;
+
+    float ideal = scale * std::sqrt(ratio);
+    float next = scale + (ideal - scale) * DRS_RESPONSE;
+    next = std::round(next / DRS_SCALE_STEP) * DRS_SCALE_STEP;
+    if (next == scale) next += (ratio < 1.0f) ? -DRS_SCALE_STEP : DRS_SCALE_STEP; // Outside the deadband always take at least one step
+    return std::min(settings.maxScale, std::max(settings.minScale, next));
+}
@@ -0,0 +1,46 @@
+// Dynamic resolution scaling: the scene is rendered into an offscreen framebuffer whose
+// viewport shrinks or grows to hold a GPU frame-time target, then upscaled to the window.
+#pragma once
+
+// --- Dynamic Resolution Configuration ---
+const int DRS_QUERY_COUNT = 4;            // Timer queries in flight; results are read a few frames late to avoid stalls
+const float DRS_SMOOTHING = 0.1f;         // EMA weight of each new GPU time sample
+const float DRS_DEADBAND = 0.05f;         // No change while within +-5% of the target
+const float DRS_RESPONSE = 0.25f;         // Fraction of the way to the ideal scale moved per adjustment
+const float DRS_SCALE_STEP = 1.0f / 64.0f; // Scale is quantized so tiny corrections don't shimmer
+const int DRS_SETTLE_SAMPLES = 8;         // Samples to wait after a change so the average reflects the new scale
+
+struct DynamicResolutionSettings {
+    float targetFrameMs = 16.6f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+};
+
+struct DynamicResolution {
+    DynamicResolutionSettings settings;
+    unsigned int FBO = 0;
+    unsigned int colorRenderbuffer = 0;
+    unsigned int depthRenderbuffer = 0;
+    int windowWidth = 0, windowHeight = 0;   // Size the render target was allocated for
+    int targetWidth = 0, targetHeight = 0;   // Allocated size (window * maxScale)
+    int renderWidth = 0, renderHeight = 0;   // Viewport used this frame (window * scale)
+    float scale = 1.0f;                      // Current per-axis resolution scale
+    float smoothedGpuMs = 0.0f;              // 0 until the first timer result arrives
+    int samplesSinceChange = 0;
+    unsigned int queries[DRS_QUERY_COUNT] = {};
+    bool queryPending[DRS_QUERY_COUNT] = {};
+    int queryGeneration[DRS_QUERY_COUNT] = {};
+    int resizeGeneration = 0;                // Bumped on resize so stale timings are dropped
+    int frameIndex = 0;
+};
+
+bool initDynamicResolution(DynamicResolution& drs, const DynamicResolutionSettings& settings);
+// Reallocates the target when the window size changed, binds it with the scaled viewport and
+// starts the GPU timer. Returns false (nothing bound) for a zero-sized, e.g. minimized, window.
+bool beginDynamicResolutionFrame(DynamicResolution& drs, int windowWidth, int windowHeight);
+// Stops the timer, upscales into the default framebuffer and feeds finished timings to the controller.
+void endDynamicResolutionFrame(DynamicResolution& drs);
+void destroyDynamicResolution(DynamicResolution& drs);
+
+// Controller step: the scale that moves the smoothed GPU time towards the target.
+float computeResolutionScale(float scale, float smoothedGpuMs, const DynamicResolutionSettings& settings);
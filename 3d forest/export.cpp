@@ -0,0 +1,543 @@
+#include "export.h"
+#include "world.h"
+#include "world_graph.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX // Keep std::min/std::max usable
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "Psapi.lib") // Link against Psapi for GetProcessMemoryInfo
+#else
+#include <sys/resource.h>
+#endif
+
+// --- Output Regions ---
+// The file is written as a set of regions whose offsets are known up front (a .glb's
+// per-type accessors, or the single OBJ body). Parts arrive in world order, interleaving
+// types, so each region buffers on its own and flushes with a seek plus one large write.
+
+struct ExportFile {
+    FILE* file = NULL;
+    uint64_t bytesWritten = 0;
+    bool failed = false;
+};
+
+struct ExportStream {
+    uint64_t offset = 0;          // Where the next flush lands in the file
+    std::vector<uint8_t> buffer;  // Capacity EXPORT_STREAM_BUFFER_BYTES
+    size_t used = 0;
+};
+
+// fopen is an error under MSVC's SDL checks, which the Windows project enables
+static FILE* openFile(const std::string& path, const char* mode) {
+#ifdef _WIN32
+    FILE* file = NULL;
+    return fopen_s(&file, path.c_str(), mode) == 0 ? file : NULL;
+#else
+    return fopen(path.c_str(), mode);
+#endif
+}
+
+static bool openExportFile(ExportFile& out, const std::string& path) {
+    out = ExportFile();
+    out.file = openFile(path, "wb");
+    if (!out.file) {
+        std::cerr << "ERROR::EXPORT::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+    setvbuf(out.file, NULL, _IONBF, 0); // Writes are already large; skip the stdio copy
+    return true;
+}
+
+static bool closeExportFile(ExportFile& out) {
+    if (out.file && fclose(out.file) != 0) out.failed = true;
+    out.file = NULL;
+    return !out.failed;
+}
+
+static void writeAt(ExportFile& out, uint64_t offset, const void* data, size_t size) {
+    if (out.failed || size == 0) return;
+#ifdef _WIN32
+    bool seeked = _fseeki64(out.file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+    bool seeked = fseeko(out.file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    if (!seeked || fwrite(data, 1, size, out.file) != size) {
+        std::cerr << "ERROR::EXPORT::WRITE_FAILED at offset " << offset << std::endl;
+        out.failed = true;
+        return;
+    }
+    out.bytesWritten += size;
+}
+
+static void initStream(ExportStream& stream, uint64_t offset) {
+    stream.offset = offset;
+    stream.buffer.resize(EXPORT_STREAM_BUFFER_BYTES);
+    stream.used = 0;
+}
+
+static void flushStream(ExportFile& out, ExportStream& stream) {
+    writeAt(out, stream.offset, stream.buffer.data(), stream.used);
+    stream.offset += stream.used;
+    stream.used = 0;
+}
+
+static void appendStream(ExportFile& out, ExportStream& stream, const void* data, size_t size) {
+    if (stream.used + size > stream.buffer.size()) flushStream(out, stream);
+    memcpy(stream.buffer.data() + stream.used, data, size);
+    stream.used += size;
+}
+
+// --- Cube Geometry ---
+// Corner c of the unit cube is (c & 1, c >> 1 & 1, c >> 2 & 1) - 0.5; faces are CCW from outside.
+static const int CUBE_FACES[6][4] = {
+    { 0, 4, 6, 2 }, { 1, 3, 7, 5 }, // -X, +X
+    { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, // -Y, +Y
+    { 0, 2, 3, 1 }, { 4, 5, 7, 6 }  // -Z, +Z
+};
+static const float CUBE_FACE_NORMALS[6][3] = {
+    { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 }
+};
+
+static glm::vec3 cubeCorner(int corner) {
+    return glm::vec3((corner & 1) - 0.5f, ((corner >> 1) & 1) - 0.5f, ((corner >> 2) & 1) - 0.5f);
+}
+
+static size_t countWorldObjects() {
+    return treePositions.size() + bushPositions.size() + housePositions.size() + apartmentTowerPositions.size() + balconyData.size();
+}
+
+// Materials are written in linear space; the renderer's colors are sRGB-ish constants
+static float toLinear(float c) { return std::pow(c, 2.2f); }
+
+// --- glTF Binary ---
+
+const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+const int GL_FLOAT_COMPONENT = 5126;
+const int GL_UNSIGNED_SHORT_COMPONENT = 5123;
+const int GL_UNSIGNED_INT_COMPONENT = 5125;
+
+struct GltfJson {
+    std::ostringstream bufferViews, accessors, meshes, nodes;
+    int bufferViewCount = 0, accessorCount = 0, meshCount = 0, nodeCount = 0;
+};
+
+static int addAccessor(GltfJson& json, uint64_t offset, uint64_t byteLength, int componentType, size_t count, const char* type, int target,
+                       const float* minValues = NULL, const float* maxValues = NULL) {
+    json.bufferViews << (json.bufferViewCount ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << offset << ",\"byteLength\":" << byteLength;
+    if (target) json.bufferViews << ",\"target\":" << target;
+    json.bufferViews << "}";
+    json.accessors << (json.accessorCount ? "," : "") << "{\"bufferView\":" << json.bufferViewCount << ",\"componentType\":" << componentType
+                   << ",\"count\":" << count << ",\"type\":\"" << type << "\"";
+    if (minValues && maxValues) {
+        json.accessors.precision(17); // Exact decimal for the float, so no vertex lands outside min/max
+        json.accessors << ",\"min\":[" << minValues[0] << "," << minValues[1] << "," << minValues[2] << "]"
+                       << ",\"max\":[" << maxValues[0] << "," << maxValues[1] << "," << maxValues[2] << "]";
+    }
+    json.accessors << "}";
+    json.bufferViewCount++;
+    return json.accessorCount++;
+}
+
+static std::string gltfMaterials() {
+    std::ostringstream materials;
+    for (int type = 0; type < PART_COUNT; ++type) {
+        glm::vec3 color = WORLD_PART_COLORS[type];
+        materials << (type ? "," : "") << "{\"name\":\"" << WORLD_PART_NAMES[type] << "\",\"pbrMetallicRoughness\":{\"baseColorFactor\":["
+                  << toLinear(color.r) << "," << toLinear(color.g) << "," << toLinear(color.b) << ",1],\"metallicFactor\":0,\"roughnessFactor\":1}";
+        if (type == PART_SUN) materials << ",\"emissiveFactor\":[" << toLinear(color.r) << "," << toLinear(color.g) << "," << toLinear(color.b) << "]";
+        materials << "}";
+    }
+    return materials.str();
+}
+
+// Writes the GLB header and JSON chunk, and returns the file offset where BIN data starts
+static uint64_t writeGlbHeader(ExportFile& out, const GltfJson& json, bool instanced, uint64_t binLength) {
+    std::ostringstream document;
+    document << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"3d forest streaming exporter\"}";
+    if (instanced) document << ",\"extensionsUsed\":[\"EXT_mesh_gpu_instancing\"],\"extensionsRequired\":[\"EXT_mesh_gpu_instancing\"]";
+    document << ",\"scene\":0,\"scenes\":[{\"nodes\":[";
+    for (int i = 0; i < json.nodeCount; ++i) document << (i ? "," : "") << i;
+    document << "]}],\"nodes\":[" << json.nodes.str() << "],\"meshes\":[" << json.meshes.str() << "],\"materials\":[" << gltfMaterials()
+             << "],\"accessors\":[" << json.accessors.str() << "],\"bufferViews\":[" << json.bufferViews.str()
+             << "],\"buffers\":[{\"byteLength\":" << binLength << "}]}";
+    std::string text = document.str();
+    while (text.size() % 4) text += ' '; // Chunks are 4-byte aligned, JSON pads with spaces
+
+    uint32_t header[5] = { GLB_MAGIC, 2, static_cast<uint32_t>(12 + 8 + text.size() + 8 + binLength),
+                           static_cast<uint32_t>(text.size()), GLB_CHUNK_JSON };
+    uint32_t binHeader[2] = { static_cast<uint32_t>(binLength), GLB_CHUNK_BIN };
+    writeAt(out, 0, header, sizeof(header));
+    writeAt(out, sizeof(header), text.data(), text.size());
+    writeAt(out, sizeof(header) + text.size(), binHeader, sizeof(binHeader));
+    return sizeof(header) + text.size() + sizeof(binHeader);
+}
+
+static bool checkGlbSize(uint64_t binLength) {
+    // GLB stores its total length in 32 bits; leave room for the JSON chunk
+    if (binLength > 0xFFFFFFFFull - (16u << 20)) {
+        std::cerr << "ERROR::EXPORT::GLB_TOO_LARGE " << binLength << " bytes of geometry; use the instanced .glb or .obj" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Shared cube (24 vertices for flat normals) plus TRANSLATION and SCALE per part type
+static bool exportGlbInstanced(ExportFile& out, ExportStats& stats) {
+    size_t counts[PART_COUNT];
+    countWorldParts(counts);
+
+    const uint64_t meshPositionBytes = 24 * 12, meshNormalBytes = 24 * 12, meshIndexBytes = 36 * 2;
+    GltfJson json;
+    const float cubeMin[3] = { -0.5f, -0.5f, -0.5f }, cubeMax[3] = { 0.5f, 0.5f, 0.5f };
+    int positionAccessor = addAccessor(json, 0, meshPositionBytes, GL_FLOAT_COMPONENT, 24, "VEC3", 34962, cubeMin, cubeMax);
+    int normalAccessor = addAccessor(json, meshPositionBytes, meshNormalBytes, GL_FLOAT_COMPONENT, 24, "VEC3", 34962);
+    int indexAccessor = addAccessor(json, meshPositionBytes + meshNormalBytes, meshIndexBytes, GL_UNSIGNED_SHORT_COMPONENT, 36, "SCALAR", 34963);
+
+    uint64_t binLength = meshPositionBytes + meshNormalBytes + meshIndexBytes;
+    uint64_t translationOffsets[PART_COUNT] = {}, scaleOffsets[PART_COUNT] = {};
+    for (int type = 0; type < PART_COUNT; ++type) {
+        if (counts[type] == 0) continue;
+        uint64_t bytes = counts[type] * 12ull;
+        translationOffsets[type] = binLength;
+        scaleOffsets[type] = binLength + bytes;
+        int translationAccessor = addAccessor(json, translationOffsets[type], bytes, GL_FLOAT_COMPONENT, counts[type], "VEC3", 0);
+        int scaleAccessor = addAccessor(json, scaleOffsets[type], bytes, GL_FLOAT_COMPONENT, counts[type], "VEC3", 0);
+        binLength += bytes * 2;
+
+        json.meshes << (json.meshCount ? "," : "") << "{\"name\":\"" << WORLD_PART_NAMES[type] << "\",\"primitives\":[{\"attributes\":{\"POSITION\":"
+                    << positionAccessor << ",\"NORMAL\":" << normalAccessor << "},\"indices\":" << indexAccessor << ",\"material\":" << type << "}]}";
+        json.nodes << (json.nodeCount ? "," : "") << "{\"name\":\"" << WORLD_PART_NAMES[type] << "\",\"mesh\":" << json.meshCount
+                   << ",\"extensions\":{\"EXT_mesh_gpu_instancing\":{\"attributes\":{\"TRANSLATION\":" << translationAccessor
+                   << ",\"SCALE\":" << scaleAccessor << "}}}}";
+        json.meshCount++;
+        json.nodeCount++;
+    }
+    if (!checkGlbSize(binLength)) return false;
+    uint64_t binStart = writeGlbHeader(out, json, true, binLength);
+
+    // Shared cube
+    float positions[24 * 3], normals[24 * 3];
+    uint16_t indices[36];
+    for (int face = 0; face < 6; ++face) {
+        for (int i = 0; i < 4; ++i) {
+            glm::vec3 corner = cubeCorner(CUBE_FACES[face][i]);
+            int v = face * 4 + i;
+            positions[v * 3 + 0] = corner.x; positions[v * 3 + 1] = corner.y; positions[v * 3 + 2] = corner.z;
+            normals[v * 3 + 0] = CUBE_FACE_NORMALS[face][0]; normals[v * 3 + 1] = CUBE_FACE_NORMALS[face][1]; normals[v * 3 + 2] = CUBE_FACE_NORMALS[face][2];
+        }
+        const uint16_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i = 0; i < 6; ++i) indices[face * 6 + i] = static_cast<uint16_t>(face * 4 + quad[i]);
+    }
+    writeAt(out, binStart, positions, sizeof(positions));
+    writeAt(out, binStart + meshPositionBytes, normals, sizeof(normals));
+    writeAt(out, binStart + meshPositionBytes + meshNormalBytes, indices, sizeof(indices));
+
+    // Instances, streamed
+    std::vector<ExportStream> translations(PART_COUNT), scales(PART_COUNT);
+    for (int type = 0; type < PART_COUNT; ++type) {
+        if (counts[type] == 0) continue;
+        initStream(translations[type], binStart + translationOffsets[type]);
+        initStream(scales[type], binStart + scaleOffsets[type]);
+        stats.bufferBytes += 2 * EXPORT_STREAM_BUFFER_BYTES;
+    }
+    std::vector<WorldPart> chunk(EXPORT_CHUNK_PARTS);
+    stats.bufferBytes += chunk.size() * sizeof(WorldPart);
+    size_t fetched;
+    for (size_t first = 0; (fetched = getWorldParts(first, chunk.size(), chunk.data())) > 0 && !out.failed; first += fetched) {
+        for (size_t i = 0; i < fetched; ++i) {
+            const WorldPart& part = chunk[i];
+            appendStream(out, translations[part.type], &part.center, sizeof(float) * 3);
+            appendStream(out, scales[part.type], &part.size, sizeof(float) * 3);
+        }
+        stats.parts += fetched;
+    }
+    for (int type = 0; type < PART_COUNT; ++type) {
+        if (counts[type] == 0) continue;
+        flushStream(out, translations[type]);
+        flushStream(out, scales[type]);
+    }
+    return !out.failed;
+}
+
+// Every part becomes 8 world-space vertices and 36 indices in its type's primitive.
+// Flat normals are left to the importer (glTF's default when NORMAL is absent).
+static bool exportGlbExpanded(ExportFile& out, ExportStats& stats) {
+    size_t counts[PART_COUNT];
+    countWorldParts(counts);
+    std::vector<WorldPart> chunk(EXPORT_CHUNK_PARTS);
+    stats.bufferBytes += chunk.size() * sizeof(WorldPart);
+
+    // POSITION needs bounds in the JSON, which precedes the data: take them in a first pass
+    glm::vec3 boundsMin[PART_COUNT], boundsMax[PART_COUNT];
+    for (int type = 0; type < PART_COUNT; ++type) {
+        boundsMin[type] = glm::vec3(INFINITY);
+        boundsMax[type] = glm::vec3(-INFINITY);
+    }
+    size_t fetched;
+    for (size_t first = 0; (fetched = getWorldParts(first, chunk.size(), chunk.data())) > 0; first += fetched) {
+        for (size_t i = 0; i < fetched; ++i) {
+            const WorldPart& part = chunk[i];
+            boundsMin[part.type] = glm::min(boundsMin[part.type], part.center - part.size * 0.5f);
+            boundsMax[part.type] = glm::max(boundsMax[part.type], part.center + part.size * 0.5f);
+        }
+    }
+
+    GltfJson json;
+    uint64_t binLength = 0;
+    uint64_t positionOffsets[PART_COUNT] = {}, indexOffsets[PART_COUNT] = {};
+    for (int type = 0; type < PART_COUNT; ++type) {
+        if (counts[type] == 0) continue;
+        uint64_t positionBytes = counts[type] * 8 * 12ull, indexBytes = counts[type] * 36 * 4ull;
+        positionOffsets[type] = binLength;
+        indexOffsets[type] = binLength + positionBytes;
+        const float minValues[3] = { boundsMin[type].x, boundsMin[type].y, boundsMin[type].z };
+        const float maxValues[3] = { boundsMax[type].x, boundsMax[type].y, boundsMax[type].z };
+        int positionAccessor = addAccessor(json, positionOffsets[type], positionBytes, GL_FLOAT_COMPONENT, counts[type] * 8, "VEC3", 34962, minValues, maxValues);
+        int indexAccessor = addAccessor(json, indexOffsets[type], indexBytes, GL_UNSIGNED_INT_COMPONENT, counts[type] * 36, "SCALAR", 34963);
+        binLength += positionBytes + indexBytes;
+
+        json.meshes << (json.meshCount ? "," : "") << "{\"name\":\"" << WORLD_PART_NAMES[type] << "\",\"primitives\":[{\"attributes\":{\"POSITION\":"
+                    << positionAccessor << "},\"indices\":" << indexAccessor << ",\"material\":" << type << "}]}";
+        json.nodes << (json.nodeCount ? "," : "") << "{\"name\":\"" << WORLD_PART_NAMES[type] << "\",\"mesh\":" << json.meshCount << "}";
+        json.meshCount++;
+        json.nodeCount++;
+    }
+    if (!checkGlbSize(binLength)) return false;
+    uint64_t binStart = writeGlbHeader(out, json, false, binLength);
+
+    std::vector<ExportStream> positions(PART_COUNT), indices(PART_COUNT);
+    uint32_t nextVertex[PART_COUNT] = {};
+    for (int type = 0; type < PART_COUNT; ++type) {
+        if (counts[type] == 0) continue;
+        initStream(positions[type], binStart + positionOffsets[type]);
+        initStream(indices[type], binStart + indexOffsets[type]);
+        stats.bufferBytes += 2 * EXPORT_STREAM_BUFFER_BYTES;
+    }
+    for (size_t first = 0; (fetched = getWorldParts(first, chunk.size(), chunk.data())) > 0 && !out.failed; first += fetched) {
+        for (size_t i = 0; i < fetched; ++i) {
+            const WorldPart& part = chunk[i];
+            float vertices[8 * 3];
+            for (int corner = 0; corner < 8; ++corner) {
+                glm::vec3 v = part.center + part.size * cubeCorner(corner);
+                vertices[corner * 3 + 0] = v.x; vertices[corner * 3 + 1] = v.y; vertices[corner * 3 + 2] = v.z;
+            }
+            uint32_t triangles[36];
+            uint32_t base = nextVertex[part.type];
+            for (int face = 0; face < 6; ++face) {
+                const int* quad = CUBE_FACES[face];
+                uint32_t* tri = triangles + face * 6;
+                tri[0] = base + quad[0]; tri[1] = base + quad[1]; tri[2] = base + quad[2];
+                tri[3] = base + quad[0]; tri[4] = base + quad[2]; tri[5] = base + quad[3];
+            }
+            nextVertex[part.type] += 8;
+            appendStream(out, positions[part.type], vertices, sizeof(vertices));
+            appendStream(out, indices[part.type], triangles, sizeof(triangles));
+        }
+        stats.parts += fetched;
+    }
+    for (int type = 0; type < PART_COUNT; ++type) {
+        if (counts[type] == 0) continue;
+        flushStream(out, positions[type]);
+        flushStream(out, indices[type]);
+    }
+    return !out.failed;
+}
+
+// --- Wavefront OBJ ---
+
+// Fixed point with 4 decimals (0.1 mm): far faster than printf and exact enough for cubes
+static char* formatFixed(char* p, float value) {
+    long long scaled = std::llround(static_cast<double>(value) * 10000.0);
+    if (scaled < 0) { *p++ = '-'; scaled = -scaled; }
+    long long whole = scaled / 10000;
+    int fraction = static_cast<int>(scaled % 10000);
+    char digits[24];
+    int n = 0;
+    do { digits[n++] = static_cast<char>('0' + whole % 10); whole /= 10; } while (whole);
+    while (n) *p++ = digits[--n];
+    *p++ = '.';
+    p[0] = static_cast<char>('0' + fraction / 1000);
+    p[1] = static_cast<char>('0' + fraction / 100 % 10);
+    p[2] = static_cast<char>('0' + fraction / 10 % 10);
+    p[3] = static_cast<char>('0' + fraction % 10);
+    return p + 4;
+}
+
+static char* formatUnsigned(char* p, uint64_t value) {
+    char digits[24];
+    int n = 0;
+    do { digits[n++] = static_cast<char>('0' + value % 10); value /= 10; } while (value);
+    while (n) *p++ = digits[--n];
+    return p;
+}
+
+static bool writeObjMaterials(const std::string& path) {
+    FILE* file = openFile(path, "w");
+    if (!file) {
+        std::cerr << "ERROR::EXPORT::CANNOT_OPEN " << path << std::endl;
+        return false;
+    }
+    for (int type = 0; type < PART_COUNT; ++type) {
+        glm::vec3 color = WORLD_PART_COLORS[type];
+        fprintf(file, "newmtl %s\nKa 0 0 0\nKd %.4f %.4f %.4f\nKs 0 0 0\nd 1\nillum 1\n", WORLD_PART_NAMES[type], color.r, color.g, color.b);
+        if (type == PART_SUN) fprintf(file, "Ke %.4f %.4f %.4f\n", color.r, color.g, color.b);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+static bool exportObj(ExportFile& out, const std::string& path, ExportStats& stats) {
+    // Materials go next to the .obj with the same base name
+    std::string materialPath = path.substr(0, path.find_last_of('.')) + ".mtl";
+    std::string materialName = materialPath.substr(materialPath.find_last_of("/\\") + 1);
+    if (!writeObjMaterials(materialPath)) return false;
+
+    ExportStream body;
+    initStream(body, 0);
+    std::vector<WorldPart> chunk(EXPORT_CHUNK_PARTS);
+    stats.bufferBytes += EXPORT_STREAM_BUFFER_BYTES + chunk.size() * sizeof(WorldPart);
+
+    std::string header = "# 3d forest world export\nmtllib " + materialName + "\n";
+    for (int face = 0; face < 6; ++face) {
+        header += "vn " + std::to_string(static_cast<int>(CUBE_FACE_NORMALS[face][0])) + " " + std::to_string(static_cast<int>(CUBE_FACE_NORMALS[face][1])) +
+                  " " + std::to_string(static_cast<int>(CUBE_FACE_NORMALS[face][2])) + "\n";
+    }
+    appendStream(out, body, header.data(), header.size());
+
+    // Worst case for one part: 8 vertex lines plus 6 face lines plus a usemtl
+    char text[2048];
+    uint64_t vertexBase = 1; // OBJ indices are 1-based and global
+    int currentType = -1;
+    size_t fetched;
+    for (size_t first = 0; (fetched = getWorldParts(first, chunk.size(), chunk.data())) > 0 && !out.failed; first += fetched) {
+        for (size_t i = 0; i < fetched; ++i) {
+            const WorldPart& part = chunk[i];
+            char* p = text;
+            if (part.type != currentType) {
+                int written = snprintf(p, sizeof(text) - (p - text), "usemtl %s\n", WORLD_PART_NAMES[part.type]);
+                if (written > 0) p += std::min(static_cast<size_t>(written), sizeof(text) - 1 - (p - text));
+                currentType = part.type;
+            }
+            for (int corner = 0; corner < 8; ++corner) {
+                glm::vec3 v = part.center + part.size * cubeCorner(corner);
+                *p++ = 'v'; *p++ = ' ';
+                p = formatFixed(p, v.x); *p++ = ' ';
+                p = formatFixed(p, v.y); *p++ = ' ';
+                p = formatFixed(p, v.z); *p++ = '\n';
+            }
+            for (int face = 0; face < 6; ++face) {
+                *p++ = 'f';
+                for (int k = 0; k < 4; ++k) {
+                    *p++ = ' ';
+                    p = formatUnsigned(p, vertexBase + CUBE_FACES[face][k]);
+                    *p++ = '/'; *p++ = '/';
+                    *p++ = static_cast<char>('1' + face);
+                }
+                *p++ = '\n';
+            }
+            vertexBase += 8;
+            appendStream(out, body, text, p - text);
+        }
+        stats.parts += fetched;
+    }
+    flushStream(out, body);
+    return !out.failed;
+}
+
+// --- Entry Points ---
+
+ExportFormat exportFormatForPath(const std::string& path, bool expanded) {
+    size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot);
+    for (auto& c : extension) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if (extension == ".obj") return EXPORT_OBJ;
+    return expanded ? EXPORT_GLB_EXPANDED : EXPORT_GLB_INSTANCED;
+}
+
+bool exportWorld(const std::string& path, ExportFormat format, ExportStats* stats) {
+    ExportStats local;
+    auto start = std::chrono::steady_clock::now();
+    ExportFile out;
+    if (!openExportFile(out, path)) return false;
+
+    bool ok;
+    if (format == EXPORT_OBJ) ok = exportObj(out, path, local);
+    else if (format == EXPORT_GLB_EXPANDED) ok = exportGlbExpanded(out, local);
+    else ok = exportGlbInstanced(out, local);
+    ok = closeExportFile(out) && ok;
+
+    local.objects = countWorldObjects();
+    local.bytesWritten = out.bytesWritten;
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats) *stats = local;
+    return ok;
+}
+
+size_t getPeakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);        // Bytes on macOS
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+#endif
+}
+
+// --- Benchmark ---
+
+void runExportBenchmark() {
+    // Object counts scale with the world; the area grows too so density stays the same
+    const int scales[] = { 1, 100, 1000 };
+    const struct { ExportFormat format; const char* name; const char* path; int maxScale; } formats[] = {
+        { EXPORT_GLB_INSTANCED, "glb instanced", "exportbench.glb", 1000 },
+        { EXPORT_GLB_EXPANDED, "glb expanded", "exportbench_expanded.glb", 1000 },
+        { EXPORT_OBJ, "obj", "exportbench.obj", 100 } // ~2 GB of text at 1000x; the rate is already clear at 100x
+    };
+    const double mib = 1024.0 * 1024.0;
+    std::cout << std::fixed;
+    std::cout.precision(1);
+    for (int scale : scales) {
+        generateScaledWorld(1, scale);
+        size_t worldBytes = (treePositions.capacity() + bushPositions.capacity() + housePositions.capacity() + apartmentTowerPositions.capacity()) * sizeof(glm::vec3) +
+                            balconyData.capacity() * sizeof(Balcony);
+        size_t rssBefore = getPeakRssBytes();
+        std::cout << "[exportbench] " << scale << "x world: " << countWorldObjects() << " objects, " << countWorldParts() << " parts, "
+                  << worldBytes / mib << " MiB of world data, peak RSS " << rssBefore / mib << " MiB" << std::endl;
+
+        for (const auto& entry : formats) {
+            if (scale > entry.maxScale) continue;
+            ExportStats stats;
+            bool ok = exportWorld(entry.path, entry.format, &stats);
+            size_t rssAfter = getPeakRssBytes();
+            std::cout << "[exportbench]   " << entry.name << ": " << (ok ? "" : "FAILED, ")
+                      << stats.objects / stats.seconds << " objects/s, " << stats.parts / stats.seconds << " parts/s, "
+                      << stats.bytesWritten / mib / stats.seconds << " MiB/s (" << stats.bytesWritten / mib << " MiB in " << stats.seconds << " s), "
+                      << "buffers " << stats.bufferBytes / mib << " MiB, peak RSS " << rssAfter / mib << " MiB (+"
+                      << (rssAfter - std::min(rssAfter, rssBefore)) / mib << ")" << std::endl;
+            remove(entry.path);
+            if (entry.format == EXPORT_OBJ) remove("exportbench.mtl");
+            rssBefore = rssAfter;
+        }
+    }
+}
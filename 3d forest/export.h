@@ -0,0 +1,34 @@
+// Streaming export of the generated world to glTF 2.0 binary (.glb) and Wavefront OBJ.
+// Parts are pulled from getWorldParts() a chunk at a time and written through fixed-size
+// buffers, so memory use stays flat however many objects the world holds.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// --- Export Configuration ---
+const size_t EXPORT_CHUNK_PARTS = 4096;               // Parts fetched from the world per step
+const size_t EXPORT_STREAM_BUFFER_BYTES = 256 * 1024; // Per output region, flushed as one large write
+
+enum ExportFormat {
+    EXPORT_GLB_INSTANCED, // One shared cube mesh, EXT_mesh_gpu_instancing node per part type
+    EXPORT_GLB_EXPANDED,  // Every cube baked into world-space vertices
+    EXPORT_OBJ            // Text, plus a .mtl with one material per part type
+};
+
+struct ExportStats {
+    size_t objects = 0;       // Trees, bushes, houses, towers and balconies
+    size_t parts = 0;         // Cubes written, including ground and sun
+    uint64_t bytesWritten = 0;
+    size_t bufferBytes = 0;   // Exporter working memory
+    double seconds = 0.0;
+};
+
+// Picks the format from the extension: .obj, otherwise .glb (instanced unless `expanded`).
+ExportFormat exportFormatForPath(const std::string& path, bool expanded);
+bool exportWorld(const std::string& path, ExportFormat format, ExportStats* stats = NULL);
+size_t getPeakRssBytes();
+
+// Generates worlds at increasing scale and exports each format, printing objects/sec and peak RSS.
+void runExportBenchmark();
@@ -0,0 +1,113 @@
+#include <glad/glad.h> // Must be included before GLFW
+#include <GLFW/glfw3.h>
+#include "input_latency.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+void initInputLatency(InputLatency& latency, GLFWwindow* window, const InputLatencySettings& settings) {
+    latency = InputLatency();
+    latency.settings = settings;
+    latency.latencyMs.assign(LATENCY_HISTORY, 0.0f);
+    latency.sortedMs.reserve(LATENCY_HISTORY);
+
+    if (settings.rawMouseMotion) {
+        if (glfwRawMouseMotionSupported()) glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+        else std::cout << "Raw mouse motion not supported, using the system cursor" << std::endl;
+    }
+
+    GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+    if (!monitor) monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = monitor ? glfwGetVideoMode(monitor) : NULL;
+    if (mode && mode->refreshRate > 0) latency.refreshPeriod = 1.0 / mode->refreshRate;
+    else if (settings.waitForDeadline) std::cout << "Refresh rate unknown, not waiting for the vsync deadline" << std::endl;
+
+    latency.lastPresentTime = latency.frameStartTime = latency.lastReportTime = glfwGetTime();
+}
+
+double computeInputWaitSeconds(double sinceLastPresent, double refreshPeriod, double predictedCost, double marginSeconds) {
+    if (refreshPeriod <= 0.0) return 0.0;
+    // The present that just returned sits on a vblank; aim to finish right before the next one
+    double wait = refreshPeriod - predictedCost - marginSeconds - sinceLastPresent;
+    return std::max(0.0, wait);
+}
+
+void beginInputLatencyFrame(InputLatency& latency) {
+    latency.waitSeconds = 0.0;
+    if (latency.settings.waitForDeadline) {
+        double now = glfwGetTime();
+        double wait = computeInputWaitSeconds(now - latency.lastPresentTime, latency.refreshPeriod,
+                                              latency.smoothedCostSeconds * LATENCY_COST_HEADROOM,
+                                              latency.settings.safetyMarginMs / 1000.0 + latency.extraMarginSeconds);
+        double wakeTime = now + wait;
+        // OS sleeps overshoot by a millisecond or more, so yield through the last stretch
+        if (wait > LATENCY_SPIN_SECONDS) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait - LATENCY_SPIN_SECONDS));
+        }
+        while (glfwGetTime() < wakeTime) std::this_thread::yield();
+        latency.waitSeconds = wait;
+    }
+    latency.frameStartTime = glfwGetTime();
+}
+
+void markInputSampled(InputLatency& latency) {
+    latency.inputSampleTime = glfwGetTime();
+}
+
+void presentInputLatencyFrame(InputLatency& latency, GLFWwindow* window, float gpuMs) {
+    // When waiting for the deadline, finish rendering first so the predicted cost includes the
+    // GPU's share; otherwise one glFinish per frame (below) is enough
+    if (latency.settings.waitForDeadline) glFinish();
+    double renderedTime = glfwGetTime();
+    glfwSwapBuffers(window);
+    // ...and again after the swap: otherwise the driver queues frames behind SwapBuffers and
+    // input ages by whole frames before it is shown
+    if (latency.settings.latePolling) glFinish();
+    double presentTime = glfwGetTime();
+
+    // Without the first glFinish only the CPU side is timed; the DRS GPU time (if any) fills in
+    double cost = std::max(renderedTime - latency.frameStartTime, gpuMs / 1000.0);
+    latency.smoothedCostSeconds = latency.smoothedCostSeconds == 0.0 ? cost : latency.smoothedCostSeconds + (cost - latency.smoothedCostSeconds) * LATENCY_SMOOTHING;
+
+    // A present more than a period and a half after the previous one skipped a vblank. If we
+    // slept first, the sleep (or a cost spike) is to blame, so keep more slack for a while.
+    if (latency.refreshPeriod > 0.0 && presentTime - latency.lastPresentTime > latency.refreshPeriod * 1.5) {
+        latency.missedVblanks++;
+        if (latency.waitSeconds > 0.0) {
+            latency.extraMarginSeconds = std::min(latency.extraMarginSeconds + LATENCY_MISS_BACKOFF, latency.refreshPeriod);
+        }
+    }
+    else {
+        latency.extraMarginSeconds *= LATENCY_MARGIN_DECAY;
+    }
+    latency.lastPresentTime = presentTime;
+
+    latency.latencyMs[latency.samples % LATENCY_HISTORY] = static_cast<float>((presentTime - latency.inputSampleTime) * 1000.0);
+    latency.samples++;
+    latency.waitSum += latency.waitSeconds;
+    latency.framesSinceReport++;
+
+    if (presentTime - latency.lastReportTime >= LATENCY_REPORT_SECONDS) {
+        std::vector<float>& sorted = latency.sortedMs;
+        sorted.assign(latency.latencyMs.begin(), latency.latencyMs.begin() + std::min(latency.samples, LATENCY_HISTORY));
+        std::sort(sorted.begin(), sorted.end());
+        float sum = 0.0f;
+        for (float v : sorted) sum += v;
+        std::streamsize oldPrecision = std::cout.precision(1);
+        std::ios::fmtflags oldFlags = std::cout.setf(std::ios::fixed, std::ios::floatfield);
+        std::cout << "Input-to-present latency (last " << sorted.size() << " frames): avg " << sum / sorted.size()
+                  << " ms, p50 " << sorted[sorted.size() / 2] << " ms, p95 " << sorted[sorted.size() * 95 / 100]
+                  << " ms, max " << sorted.back() << " ms | frame cost " << latency.smoothedCostSeconds * 1000.0
+                  << " ms, wait " << latency.waitSum * 1000.0 / latency.framesSinceReport << " ms (+"
+                  << latency.extraMarginSeconds * 1000.0 << " ms margin), " << latency.missedVblanks << " missed vblanks, refresh "
+                  << latency.refreshPeriod * 1000.0 << " ms" << std::endl;
+        std::cout.precision(oldPrecision);
+        std::cout.flags(oldFlags);
+        latency.waitSum = 0.0;
+        latency.missedVblanks = 0;
+        latency.framesSinceReport = 0;
+        latency.lastReportTime = presentTime;
+    }
+}
@@ -0,0 +1,59 @@
+// Low-latency input: raw mouse motion, input sampled right before the frame that uses it,
+// no frames queued behind SwapBuffers, and an optional sleep after present so that sampling
+// lands just before the next vsync deadline. Input-to-present latency is measured every frame.
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct GLFWwindow;
+
+// --- Input Latency Configuration ---
+const float LATENCY_SMOOTHING = 0.1f;        // EMA weight of each new frame-cost sample
+const float LATENCY_COST_HEADROOM = 1.25f;   // Predicted frame cost is inflated by this before waiting
+const double LATENCY_SPIN_SECONDS = 0.002;   // Sleep until this close to the wake time, then yield (sleep granularity)
+const double LATENCY_MISS_BACKOFF = 0.001;   // Extra margin added after each missed vblank (seconds)
+const double LATENCY_MARGIN_DECAY = 0.995;   // Per-frame decay of that extra margin while vblanks are hit
+const double LATENCY_REPORT_SECONDS = 5.0;   // Interval between latency reports on stdout
+const size_t LATENCY_HISTORY = 1024;         // Frames kept for percentiles
+
+struct InputLatencySettings {
+    bool rawMouseMotion = false;  // Unaccelerated cursor deltas where the platform supports them
+    bool latePolling = false;     // Poll at the start of the frame and glFinish after SwapBuffers
+    bool waitForDeadline = false; // Sleep after present so the next poll is just in time for vsync
+    float safetyMarginMs = 2.0f;  // Slack left before the deadline when waiting
+};
+
+struct InputLatency {
+    InputLatencySettings settings;
+    double refreshPeriod = 0.0;     // Seconds per vblank; 0 when unknown, which disables waiting
+    double lastPresentTime = 0.0;   // When the previous frame's present returned
+    double frameStartTime = 0.0;    // When this frame's work began, after any wait
+    double inputSampleTime = 0.0;   // Poll whose input built this frame's view
+    double smoothedCostSeconds = 0.0; // Frame start until rendering finished
+    double waitSeconds = 0.0;       // Slept before this frame
+    double extraMarginSeconds = 0.0; // Grows when waiting made a frame miss its vblank
+
+    // Report
+    std::vector<float> latencyMs;   // Ring of the last LATENCY_HISTORY input-to-present samples
+    std::vector<float> sortedMs;    // Scratch for the percentiles, sized once so reports don't allocate
+    size_t samples = 0;
+    double waitSum = 0.0;
+    size_t missedVblanks = 0;       // Since the last report
+    size_t framesSinceReport = 0;
+    double lastReportTime = 0.0;
+};
+
+// Enables raw mouse motion (if asked and supported) and reads the monitor refresh rate.
+void initInputLatency(InputLatency& latency, GLFWwindow* window, const InputLatencySettings& settings);
+// Sleeps until the predicted cost of the coming frame just fits before the next vblank (when
+// waiting is enabled), then marks the start of the frame.
+void beginInputLatencyFrame(InputLatency& latency);
+// Call right after the glfwPollEvents() whose input builds this frame's view.
+void markInputSampled(InputLatency& latency);
+// Swaps, finishes the frame in low-latency mode, records the latency sample and prints the
+// report every LATENCY_REPORT_SECONDS. gpuMs (0 if unknown) also bounds the predicted cost.
+void presentInputLatencyFrame(InputLatency& latency, GLFWwindow* window, float gpuMs);
+
+// Controller step: seconds to sleep now, given the time since the last present.
+double computeInputWaitSeconds(double sinceLastPresent, double refreshPeriod, double predictedCost, double marginSeconds);
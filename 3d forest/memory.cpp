@@ -0,0 +1,198 @@
+#include "memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+const char* const MEMORY_SUBSYSTEM_NAMES[MEMORY_SUBSYSTEM_COUNT] = { "world", "geometry", "frame" };
+
+static MemoryStats memoryStats[MEMORY_SUBSYSTEM_COUNT];
+
+const MemoryStats& getMemoryStats(MemorySubsystem subsystem) {
+    return memoryStats[subsystem];
+}
+
+// --- Heap Accounting ---
+// Every operator new block carries its size in a header, so delete can subtract it again.
+// The header keeps the payload at malloc's alignment.
+static const size_t HEAP_HEADER_SIZE = 16;
+static std::atomic<size_t> heapAllocations(0);
+static std::atomic<size_t> heapLiveBytes(0);
+static std::atomic<size_t> heapPeakBytes(0);
+
+static void* heapAllocate(size_t bytes) {
+    char* block = static_cast<char*>(std::malloc(bytes + HEAP_HEADER_SIZE));
+    if (!block) return NULL;
+    *reinterpret_cast<size_t*>(block) = bytes;
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    size_t live = heapLiveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = heapPeakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !heapPeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return block + HEAP_HEADER_SIZE;
+}
+
+static void heapFree(void* pointer) {
+    if (!pointer) return;
+    char* block = static_cast<char*>(pointer) - HEAP_HEADER_SIZE;
+    heapLiveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+HeapStats getHeapStats() {
+    HeapStats stats;
+    stats.allocations = heapAllocations.load(std::memory_order_relaxed);
+    stats.liveBytes = heapLiveBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = heapPeakBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void* operator new(std::size_t bytes) {
+    void* pointer = heapAllocate(bytes);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+void* operator new[](std::size_t bytes) { return operator new(bytes); }
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept { return heapAllocate(bytes); }
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept { return heapAllocate(bytes); }
+void operator delete(void* pointer) noexcept { heapFree(pointer); }
+void operator delete[](void* pointer) noexcept { heapFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { heapFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { heapFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { heapFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { heapFree(pointer); }
+
+// --- Arena ---
+Arena::Arena(MemorySubsystem subsystem, size_t blockSize) : subsystem(subsystem), blockSize(blockSize) {}
+
+Arena::~Arena() {
+    releaseArena(*this);
+}
+
+static void addArenaBlock(Arena& arena, size_t size) {
+    ArenaBlock block;
+    block.data = static_cast<char*>(::operator new(size));
+    block.size = size;
+    arena.blocks.push_back(block);
+    MemoryStats& stats = memoryStats[arena.subsystem];
+    stats.reservedBytes += size;
+    stats.peakReservedBytes = std::max(stats.peakReservedBytes, stats.reservedBytes);
+    stats.blockAllocations++;
+}
+
+void* arenaAllocate(Arena& arena, size_t bytes, size_t alignment) {
+    MemoryStats& stats = memoryStats[arena.subsystem];
+    size_t consumedBefore = arena.usedBytes;
+    for (;;) {
+        if (arena.currentBlock < arena.blocks.size()) {
+            ArenaBlock& block = arena.blocks[arena.currentBlock];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            size_t start = static_cast<size_t>(((base + arena.offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base);
+            if (start + bytes <= block.size) {
+                arena.usedBytes += start + bytes - arena.offset;
+                arena.offset = start + bytes;
+                stats.allocations++;
+                stats.usedBytes += arena.usedBytes - consumedBefore;
+                stats.peakUsedBytes = std::max(stats.peakUsedBytes, stats.usedBytes);
+                return block.data + start;
+            }
+            // The tail of this block is skipped until the next reset
+            arena.usedBytes += block.size - arena.offset;
+            arena.currentBlock++;
+            arena.offset = 0;
+        }
+        else {
+            addArenaBlock(arena, std::max(arena.blockSize, bytes + alignment));
+        }
+    }
+}
+
+static void freeArenaBlocks(Arena& arena) {
+    MemoryStats& stats = memoryStats[arena.subsystem];
+    for (const ArenaBlock& block : arena.blocks) {
+        stats.reservedBytes -= block.size;
+        ::operator delete(block.data);
+    }
+    arena.blocks.clear();
+}
+
+static void rewindArena(Arena& arena) {
+    memoryStats[arena.subsystem].usedBytes -= arena.usedBytes;
+    arena.usedBytes = 0;
+    arena.currentBlock = 0;
+    arena.offset = 0;
+}
+
+void resetArena(Arena& arena) {
+    size_t consumed = arena.usedBytes;
+    rewindArena(arena);
+    if (arena.blocks.size() > 1) {
+        freeArenaBlocks(arena);
+        addArenaBlock(arena, std::max(arena.blockSize, consumed));
+    }
+}
+
+void resetArena(Arena& arena, size_t bytes) {
+    rewindArena(arena);
+    if (arena.blocks.size() == 1 && arena.blocks[0].size >= bytes) return;
+    freeArenaBlocks(arena);
+    addArenaBlock(arena, std::max(arena.blockSize, bytes));
+}
+
+void releaseArena(Arena& arena) {
+    rewindArena(arena);
+    freeArenaBlocks(arena);
+    std::vector<ArenaBlock>().swap(arena.blocks);
+}
+
+// --- Frame Tracking ---
+void initMemoryFrameTracker(MemoryFrameTracker& tracker, Arena& frameArena, double now) {
+    tracker = MemoryFrameTracker();
+    tracker.frameArena = &frameArena;
+    tracker.lastReportTime = now;
+    printMemoryReport();
+}
+
+void beginMemoryFrame(MemoryFrameTracker& tracker) {
+    resetArena(*tracker.frameArena);
+    tracker.heapAllocationsAtFrameStart = getHeapStats().allocations;
+}
+
+void endMemoryFrame(MemoryFrameTracker& tracker, double now) {
+    size_t allocations = getHeapStats().allocations - tracker.heapAllocationsAtFrameStart;
+    tracker.frames++;
+    tracker.frameAllocations += allocations;
+    if (allocations > 0) tracker.allocatingFrames++;
+    if (now - tracker.lastReportTime < MEMORY_REPORT_SECONDS) return;
+
+    printMemoryReport();
+    std::cout << "  frames: " << tracker.allocatingFrames << " of the last " << tracker.frames << " made heap allocations ("
+              << tracker.frameAllocations << " in total)" << std::endl;
+    tracker.frames = 0;
+    tracker.allocatingFrames = 0;
+    tracker.frameAllocations = 0;
+    tracker.lastReportTime = now;
+}
+
+void printMemoryReport() {
+    const double kib = 1024.0;
+    std::streamsize oldPrecision = std::cout.precision(1);
+    std::ios::fmtflags oldFlags = std::cout.setf(std::ios::fixed, std::ios::floatfield);
+    HeapStats heap = getHeapStats();
+    size_t arenaBytes = 0;
+    std::cout << "Memory:" << std::endl;
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        const MemoryStats& stats = memoryStats[i];
+        arenaBytes += stats.reservedBytes;
+        std::cout << "  " << MEMORY_SUBSYSTEM_NAMES[i] << ": " << stats.reservedBytes / kib << " KiB reserved (peak "
+                  << stats.peakReservedBytes / kib << "), " << stats.usedBytes / kib << " KiB used (peak " << stats.peakUsedBytes / kib
+                  << "), " << stats.allocations << " allocations from " << stats.blockAllocations << " blocks" << std::endl;
+    }
+    std::cout << "  heap: " << heap.liveBytes / kib << " KiB live (peak " << heap.peakBytes / kib << "), "
+              << (heap.liveBytes - std::min(heap.liveBytes, arenaBytes)) / kib << " KiB outside arenas, "
+              << heap.allocations << " allocations" << std::endl;
+    std::cout.precision(oldPrecision);
+    std::cout.flags(oldFlags);
+}
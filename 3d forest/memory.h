@@ -0,0 +1,135 @@
+// Arenas and memory accounting. World generation, baked geometry and per-frame scratch data are
+// bump-allocated out of large blocks and released in bulk, and every arena reports to a
+// subsystem. The global operator new/delete are replaced to count heap traffic, so the report
+// can show where the memory goes and confirm that steady-state frames allocate nothing.
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// --- Memory Configuration ---
+const size_t ARENA_DEFAULT_BLOCK_SIZE = 64 * 1024;
+const size_t ARENA_ALIGNMENT = 16;            // Default alignment, enough for any glm type
+const double MEMORY_REPORT_SECONDS = 10.0;    // Interval between memory reports on stdout
+
+enum MemorySubsystem {
+    MEMORY_WORLD = 0, // Generated object positions and balconies
+    MEMORY_GEOMETRY,  // Instance slots and the draw list baked from them
+    MEMORY_FRAME,     // Scratch data that lives for one frame
+    MEMORY_SUBSYSTEM_COUNT
+};
+extern const char* const MEMORY_SUBSYSTEM_NAMES[MEMORY_SUBSYSTEM_COUNT];
+
+struct MemoryStats {
+    size_t reservedBytes = 0;     // Arena blocks currently held
+    size_t peakReservedBytes = 0;
+    size_t usedBytes = 0;         // Handed out since the arenas' last reset
+    size_t peakUsedBytes = 0;
+    size_t allocations = 0;       // Arena allocations since start
+    size_t blockAllocations = 0;  // Heap allocations made by the arenas since start
+};
+const MemoryStats& getMemoryStats(MemorySubsystem subsystem);
+
+// Everything that went through operator new, arena blocks included (C code using malloc, like
+// the GL driver, is not seen)
+struct HeapStats {
+    size_t allocations = 0; // Since start
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+};
+HeapStats getHeapStats();
+
+// --- Arena ---
+struct ArenaBlock {
+    char* data;
+    size_t size;
+};
+struct Arena {
+    MemorySubsystem subsystem;
+    size_t blockSize;               // Minimum size of a new block
+    std::vector<ArenaBlock> blocks;
+    size_t currentBlock = 0;
+    size_t offset = 0;              // Into blocks[currentBlock]
+    size_t usedBytes = 0;           // Since the last reset, counting skipped block tails
+
+    explicit Arena(MemorySubsystem subsystem = MEMORY_FRAME, size_t blockSize = ARENA_DEFAULT_BLOCK_SIZE);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+};
+
+void* arenaAllocate(Arena& arena, size_t bytes, size_t alignment = ARENA_ALIGNMENT);
+// Invalidates everything allocated from the arena but keeps its memory. If the last cycle
+// needed several blocks they are merged into one, so a repeating workload stops touching the heap.
+void resetArena(Arena& arena);
+// resetArena() plus making sure the first block holds `bytes`, for a known upcoming size
+void resetArena(Arena& arena, size_t bytes);
+// Returns every block to the heap
+void releaseArena(Arena& arena);
+
+template <typename T>
+T* arenaAllocateArray(Arena& arena, size_t count) {
+    return static_cast<T*>(arenaAllocate(arena, count * sizeof(T), alignof(T) > ARENA_ALIGNMENT ? alignof(T) : ARENA_ALIGNMENT));
+}
+
+// Standard allocator over an arena: deallocate() is a no-op and memory comes back when the
+// arena is reset. Copies of a container share its arena, so only reset an arena once every
+// container using it has been emptied. Default-constructed, it uses the plain heap until a
+// container is move-assigned one bound to an arena.
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    Arena* arena;
+
+    ArenaAllocator() : arena(NULL) {}
+    explicit ArenaAllocator(Arena* arena) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t count) {
+        return arena ? arenaAllocateArray<T>(*arena, count) : static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+    void deallocate(T* pointer, size_t) {
+        if (!arena) ::operator delete(pointer);
+    }
+};
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Empties the vector, resets the arena behind it and makes room for `count` elements. The
+// vector must be the arena's only user.
+template <typename T>
+void resetArenaVector(ArenaVector<T>& vector, size_t count) {
+    Arena* arena = vector.get_allocator().arena;
+    ArenaVector<T>(vector.get_allocator()).swap(vector);
+    if (arena) resetArena(*arena, count * sizeof(T) + ARENA_ALIGNMENT);
+    vector.reserve(count);
+}
+
+// --- Frame Tracking ---
+// Resets the frame arena at the start of every frame and counts the heap allocations made
+// inside frames, printing a report every MEMORY_REPORT_SECONDS.
+struct MemoryFrameTracker {
+    Arena* frameArena = NULL;
+    size_t heapAllocationsAtFrameStart = 0;
+    size_t frames = 0;            // Since the last report
+    size_t allocatingFrames = 0;
+    size_t frameAllocations = 0;
+    double lastReportTime = 0.0;
+};
+void initMemoryFrameTracker(MemoryFrameTracker& tracker, Arena& frameArena, double now);
+void beginMemoryFrame(MemoryFrameTracker& tracker);
+void endMemoryFrame(MemoryFrameTracker& tracker, double now);
+
+// Bytes per subsystem, peaks, allocation counts and the heap totals
+void printMemoryReport();
@@ -0,0 +1,767 @@
+#include "multiplayer.h"
+#include "world.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+// --- Quantization ---
+// Server and predicting client both simulate on wire-precision values, so a replayed
+// input reproduces the server's result exactly instead of drifting.
+
+static int32_t quantizePosition(float v) { return static_cast<int32_t>(std::lround(v / NET_POSITION_QUANTUM)); }
+static float dequantizePosition(int32_t q) { return static_cast<float>(q) * NET_POSITION_QUANTUM; }
+static uint16_t quantizeYaw(float yaw) {
+    float wrapped = yaw - 360.0f * std::floor(yaw / 360.0f);
+    return static_cast<uint16_t>(std::lround(wrapped / 360.0f * 65536.0f) & 0xFFFF);
+}
+static float dequantizeYaw(uint16_t q) { return static_cast<float>(q) * (360.0f / 65536.0f); }
+static int16_t quantizePitch(float pitch) { return static_cast<int16_t>(std::lround(std::min(89.0f, std::max(-89.0f, pitch)) * 100.0f)); }
+static float dequantizePitch(int16_t q) { return static_cast<float>(q) / 100.0f; }
+
+static PlayerInput quantizeInput(const PlayerInput& input) {
+    PlayerInput out;
+    out.buttons = input.buttons;
+    out.yaw = dequantizeYaw(quantizeYaw(input.yaw));
+    out.pitch = dequantizePitch(quantizePitch(input.pitch));
+    return out;
+}
+
+static void quantizeState(PlayerState& state) {
+    state.position = glm::vec3(dequantizePosition(quantizePosition(state.position.x)),
+                               dequantizePosition(quantizePosition(state.position.y)),
+                               dequantizePosition(quantizePosition(state.position.z)));
+    state.velocityY = dequantizePosition(quantizePosition(state.velocityY));
+}
+
+static NetPlayerEntry makeEntry(uint16_t id, const PlayerState& state, const PlayerInput& input) {
+    NetPlayerEntry entry;
+    entry.id = id;
+    entry.x = quantizePosition(state.position.x);
+    entry.y = quantizePosition(state.position.y);
+    entry.z = quantizePosition(state.position.z);
+    entry.yaw = quantizeYaw(input.yaw);
+    entry.pitch = quantizePitch(input.pitch);
+    entry.flags = state.onGround ? 1 : 0;
+    return entry;
+}
+
+static void writeHeader(ByteWriter& writer, NetPacketType type, uint32_t token) {
+    writer.writeU8(type);
+    writer.writeU32(token);
+}
+
+// --- Snapshot Delta Encoding ---
+// Entries are sorted by id; each stores the id gap, a mask of fields that differ from the
+// baseline entry with the same id (or from zero if the baseline lacks it), then zigzag
+// varint deltas for just those fields.
+
+enum NetEntryField : uint8_t {
+    FIELD_X = 1 << 0, FIELD_Y = 1 << 1, FIELD_Z = 1 << 2,
+    FIELD_YAW = 1 << 3, FIELD_PITCH = 1 << 4, FIELD_FLAGS = 1 << 5
+};
+
+static void writeSnapshotEntries(ByteWriter& writer, const std::vector<NetPlayerEntry>& players, const NetSnapshotFrame* base) {
+    writer.writeU8(static_cast<uint8_t>(players.size()));
+    const NetPlayerEntry zero;
+    size_t baseIndex = 0;
+    uint16_t previousId = 0;
+    for (const auto& entry : players) {
+        const NetPlayerEntry* reference = &zero;
+        if (base) {
+            while (baseIndex < base->players.size() && base->players[baseIndex].id < entry.id) baseIndex++;
+            if (baseIndex < base->players.size() && base->players[baseIndex].id == entry.id) reference = &base->players[baseIndex];
+        }
+        uint8_t mask = 0;
+        if (entry.x != reference->x) mask |= FIELD_X;
+        if (entry.y != reference->y) mask |= FIELD_Y;
+        if (entry.z != reference->z) mask |= FIELD_Z;
+        if (entry.yaw != reference->yaw) mask |= FIELD_YAW;
+        if (entry.pitch != reference->pitch) mask |= FIELD_PITCH;
+        if (entry.flags != reference->flags) mask |= FIELD_FLAGS;
+
+        writer.writeVarU32(entry.id - previousId);
+        writer.writeU8(mask);
+        if (mask & FIELD_X) writer.writeVarS32(entry.x - reference->x);
+        if (mask & FIELD_Y) writer.writeVarS32(entry.y - reference->y);
+        if (mask & FIELD_Z) writer.writeVarS32(entry.z - reference->z);
+        if (mask & FIELD_YAW) writer.writeVarS32(static_cast<int16_t>(entry.yaw - reference->yaw)); // Wraps, so the short way round
+        if (mask & FIELD_PITCH) writer.writeVarS32(entry.pitch - reference->pitch);
+        if (mask & FIELD_FLAGS) writer.writeU8(entry.flags);
+        previousId = entry.id;
+    }
+}
+
+static bool readSnapshotEntries(ByteReader& reader, std::vector<NetPlayerEntry>& players, const NetSnapshotFrame* base) {
+    int count = reader.readU8();
+    players.clear();
+    players.reserve(count);
+    const NetPlayerEntry zero;
+    size_t baseIndex = 0;
+    uint16_t previousId = 0;
+    for (int i = 0; i < count && !reader.error; ++i) {
+        NetPlayerEntry entry;
+        entry.id = static_cast<uint16_t>(previousId + reader.readVarU32());
+        const NetPlayerEntry* reference = &zero;
+        if (base) {
+            while (baseIndex < base->players.size() && base->players[baseIndex].id < entry.id) baseIndex++;
+            if (baseIndex < base->players.size() && base->players[baseIndex].id == entry.id) reference = &base->players[baseIndex];
+        }
+        uint8_t mask = reader.readU8();
+        entry.x = reference->x + ((mask & FIELD_X) ? reader.readVarS32() : 0);
+        entry.y = reference->y + ((mask & FIELD_Y) ? reader.readVarS32() : 0);
+        entry.z = reference->z + ((mask & FIELD_Z) ? reader.readVarS32() : 0);
+        entry.yaw = static_cast<uint16_t>(reference->yaw + ((mask & FIELD_YAW) ? reader.readVarS32() : 0));
+        entry.pitch = static_cast<int16_t>(reference->pitch + ((mask & FIELD_PITCH) ? reader.readVarS32() : 0));
+        entry.flags = (mask & FIELD_FLAGS) ? reader.readU8() : reference->flags;
+        players.push_back(entry);
+        previousId = entry.id;
+    }
+    return !reader.error;
+}
+
+// --- Server ---
+
+bool startServer(NetServer& server, uint16_t port, unsigned int seed, bool flyMode) {
+    server = NetServer();
+    if (!openUdpSocket(server.socket, port)) return false;
+    server.seed = seed != 0 ? seed : std::max(1u, static_cast<unsigned int>(time(0)));
+    server.flyMode = flyMode;
+    generateWorld(server.seed);
+    return true;
+}
+
+void stopServer(NetServer& server) {
+    closeUdpSocket(server.socket);
+    server.clients.clear();
+    server.clientByToken.clear();
+    server.clientIdInUse.assign(server.clientIdInUse.size(), false);
+}
+
+static void sendToClient(NetServer& server, NetServerClient& client, const ByteWriter& writer) {
+    sendPacket(server.socket, client.address, writer.buffer, writer.size);
+    client.bytesSent += writer.size + NET_UDP_IP_OVERHEAD;
+}
+
+static void sendWelcome(NetServer& server, NetServerClient& client) {
+    ByteWriter writer;
+    writeHeader(writer, PACKET_WELCOME, client.token);
+    writer.writeU16(client.id);
+    writer.writeU32(server.seed);
+    writer.writeU8(server.flyMode ? 1 : 0);
+    writer.writeU8(NET_TICK_RATE);
+    writer.writeU32(static_cast<uint32_t>(quantizePosition(client.state.position.x)));
+    writer.writeU32(static_cast<uint32_t>(quantizePosition(client.state.position.y)));
+    writer.writeU32(static_cast<uint32_t>(quantizePosition(client.state.position.z)));
+    sendToClient(server, client, writer);
+}
+
+// Spread joining players over a golden-angle spiral around the single-player start so a
+// crowd doesn't stack on one point, skipping spots inside trees and buildings.
+// Gives up after NET_SPAWN_ATTEMPTS spots in a crowded world and uses the start itself.
+static glm::vec3 findSpawnPosition(uint16_t id) {
+    const float goldenAngle = 2.39996323f;
+    PlayerState start;
+    for (int attempt = 0; attempt < NET_SPAWN_ATTEMPTS; ++attempt) {
+        int k = id + attempt * 7;
+        float radius = 2.0f * std::sqrt(static_cast<float>(k));
+        glm::vec3 candidate = start.position + glm::vec3(radius * std::cos(k * goldenAngle), 0.0f, radius * std::sin(k * goldenAngle));
+        if (!checkCollision(candidate)) return candidate;
+    }
+    return start.position;
+}
+
+// Next id not held by a connected client; snapshots name remote players by id. At most
+// NET_MAX_CLIENTS are in use, so the search is short.
+static uint16_t allocateClientId(NetServer& server) {
+    while (server.nextClientId == 0 || server.clientIdInUse[server.nextClientId]) ++server.nextClientId;
+    uint16_t id = server.nextClientId++;
+    server.clientIdInUse[id] = true;
+    return id;
+}
+
+static void removeClient(NetServer& server, size_t index) {
+    server.clientIdInUse[server.clients[index].id] = false;
+    server.clientByToken.erase(server.clients[index].token);
+    if (index != server.clients.size() - 1) {
+        server.clients[index] = std::move(server.clients.back());
+        server.clientByToken[server.clients[index].token] = index;
+    }
+    server.clients.pop_back();
+}
+
+void pollServer(NetServer& server, double now) {
+    uint8_t buffer[NET_MAX_PACKET_SIZE];
+    NetAddress from;
+    int size;
+    while ((size = receivePacket(server.socket, from, buffer, sizeof(buffer))) >= 0) {
+        ByteReader reader(buffer, size);
+        uint8_t type = reader.readU8();
+        uint32_t token = reader.readU32();
+        if (reader.error || token == 0) continue;
+        auto found = server.clientByToken.find(token);
+
+        if (type == PACKET_CONNECT) {
+            if (reader.readU16() != NET_PROTOCOL_VERSION || reader.error) continue;
+            if (found == server.clientByToken.end()) {
+                // Every new token costs a client and a spawn search, so a flood stops here
+                if (server.clients.size() >= static_cast<size_t>(NET_MAX_CLIENTS)) continue;
+                NetServerClient client;
+                client.token = token;
+                client.id = allocateClientId(server);
+                client.state.position = findSpawnPosition(client.id);
+                quantizeState(client.state);
+                server.clients.push_back(std::move(client));
+                found = server.clientByToken.emplace(token, server.clients.size() - 1).first;
+            }
+            // Connect is repeated until welcomed, so answer duplicates too
+            NetServerClient& client = server.clients[found->second];
+            client.address = from;
+            client.lastHeardTime = now;
+            client.bytesReceived += size + NET_UDP_IP_OVERHEAD;
+            sendWelcome(server, client);
+            continue;
+        }
+        if (found == server.clientByToken.end()) continue;
+        NetServerClient& client = server.clients[found->second];
+        client.address = from; // Follow NAT rebinding
+        client.lastHeardTime = now;
+        client.bytesReceived += size + NET_UDP_IP_OVERHEAD;
+
+        if (type == PACKET_INPUT) {
+            uint32_t ackTick = reader.readU32();
+            uint32_t newestSequence = reader.readU32();
+            int count = reader.readU8();
+            PlayerInput inputs[NET_INPUT_REDUNDANCY];
+            count = std::min(count, NET_INPUT_REDUNDANCY);
+            for (int i = 0; i < count; ++i) {
+                inputs[i].buttons = reader.readU8();
+                inputs[i].yaw = dequantizeYaw(reader.readU16());
+                inputs[i].pitch = dequantizePitch(static_cast<int16_t>(reader.readU16()));
+            }
+            if (reader.error) continue;
+            if (ackTick > client.ackedTick && ackTick <= server.tick) client.ackedTick = ackTick;
+            // Queue oldest first, skipping anything already queued or applied
+            uint32_t lastKnown = client.pendingInputs.empty() ? client.lastInputSequence : client.pendingInputs.back().sequence;
+            for (int i = count - 1; i >= 0; --i) {
+                uint32_t sequence = newestSequence - static_cast<uint32_t>(i);
+                if (sequence > lastKnown && sequence <= newestSequence) client.pendingInputs.push_back({ sequence, inputs[i] });
+            }
+            // A client sending faster than the tick rate only loses its oldest inputs, never adds lag
+            if (client.pendingInputs.size() > static_cast<size_t>(NET_MAX_PENDING_INPUTS)) {
+                client.pendingInputs.erase(client.pendingInputs.begin(), client.pendingInputs.end() - NET_MAX_PENDING_INPUTS);
+            }
+        }
+        else if (type == PACKET_DISCONNECT) {
+            removeClient(server, found->second);
+        }
+    }
+}
+
+// --- Relevance Grid ---
+// Players bucketed into XZ cells over the ground once per tick, so finding each client's
+// nearest others searches outward ring by ring instead of scanning everyone (O(N^2)).
+// Players beyond the ground edge are clamped into the border cells.
+
+const float NET_RELEVANCE_CELL_SIZE = 25.0f;
+const int NET_RELEVANCE_GRID_DIM = static_cast<int>(GROUND_SIZE / NET_RELEVANCE_CELL_SIZE);
+
+struct NetRelevanceGrid {
+    std::vector<uint32_t> cellStart;  // NET_RELEVANCE_GRID_DIM^2 + 1 offsets into playerIndices
+    std::vector<uint32_t> playerIndices;
+};
+
+static int relevanceCell(int32_t quantized) {
+    int cell = static_cast<int>(std::floor((dequantizePosition(quantized) + GROUND_SIZE * 0.5f) / NET_RELEVANCE_CELL_SIZE));
+    return std::min(NET_RELEVANCE_GRID_DIM - 1, std::max(0, cell));
+}
+
+static void buildRelevanceGrid(NetRelevanceGrid& grid, const std::vector<NetPlayerEntry>& players) {
+    const int cellCount = NET_RELEVANCE_GRID_DIM * NET_RELEVANCE_GRID_DIM;
+    grid.cellStart.assign(cellCount + 1, 0);
+    grid.playerIndices.resize(players.size());
+    for (const auto& player : players) grid.cellStart[relevanceCell(player.z) * NET_RELEVANCE_GRID_DIM + relevanceCell(player.x) + 1]++;
+    for (int i = 0; i < cellCount; ++i) grid.cellStart[i + 1] += grid.cellStart[i];
+    std::vector<uint32_t> cursor(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    for (size_t i = 0; i < players.size(); ++i) grid.playerIndices[cursor[relevanceCell(players[i].z) * NET_RELEVANCE_GRID_DIM + relevanceCell(players[i].x)]++] = static_cast<uint32_t>(i);
+}
+
+// Fills `nearest` with up to NET_MAX_SNAPSHOT_PLAYERS (squared distance, index) pairs
+static void findNearestPlayers(const NetRelevanceGrid& grid, const std::vector<NetPlayerEntry>& players, const NetPlayerEntry& self, std::vector<std::pair<float, size_t>>& nearest) {
+    nearest.clear();
+    int cellX = relevanceCell(self.x), cellZ = relevanceCell(self.z);
+    const float quantaPerCell = NET_RELEVANCE_CELL_SIZE / NET_POSITION_QUANTUM;
+    for (int ring = 0; ring < NET_RELEVANCE_GRID_DIM; ++ring) {
+        for (int z = cellZ - ring; z <= cellZ + ring; ++z) {
+            if (z < 0 || z >= NET_RELEVANCE_GRID_DIM) continue;
+            bool edgeRow = (z == cellZ - ring || z == cellZ + ring);
+            for (int x = cellX - ring; x <= cellX + ring; x += (edgeRow || ring == 0) ? 1 : 2 * ring) {
+                if (x < 0 || x >= NET_RELEVANCE_GRID_DIM) continue;
+                int cell = z * NET_RELEVANCE_GRID_DIM + x;
+                for (uint32_t i = grid.cellStart[cell]; i < grid.cellStart[cell + 1]; ++i) {
+                    const NetPlayerEntry& other = players[grid.playerIndices[i]];
+                    if (other.id == self.id) continue;
+                    float dx = static_cast<float>(other.x - self.x), dz = static_cast<float>(other.z - self.z);
+                    nearest.push_back({ dx * dx + dz * dz, grid.playerIndices[i] });
+                }
+            }
+        }
+        if (nearest.size() >= static_cast<size_t>(NET_MAX_SNAPSHOT_PLAYERS)) {
+            std::nth_element(nearest.begin(), nearest.begin() + (NET_MAX_SNAPSHOT_PLAYERS - 1), nearest.end());
+            nearest.resize(NET_MAX_SNAPSHOT_PLAYERS);
+            // Anything in the next ring is at least `ring` whole cells away
+            float ringDistance = ring * quantaPerCell;
+            float farthest = 0.0f;
+            for (const auto& candidate : nearest) farthest = std::max(farthest, candidate.first);
+            if (ringDistance * ringDistance >= farthest) return;
+        }
+    }
+}
+
+static void sendSnapshot(NetServer& server, NetServerClient& client, const std::vector<NetPlayerEntry>& allPlayers, const NetRelevanceGrid& grid, std::vector<std::pair<float, size_t>>& nearest) {
+    // Relevance: the nearest others, so snapshots stay one datagram at any player count
+    NetSnapshotFrame& frame = client.history[server.tick % NET_SNAPSHOT_HISTORY];
+    frame.tick = server.tick;
+    frame.players.clear();
+    NetPlayerEntry self = makeEntry(client.id, client.state, client.lastInput);
+    findNearestPlayers(grid, allPlayers, self, nearest);
+    for (const auto& candidate : nearest) frame.players.push_back(allPlayers[candidate.second]);
+    std::sort(frame.players.begin(), frame.players.end(), [](const NetPlayerEntry& a, const NetPlayerEntry& b) { return a.id < b.id; });
+
+    const NetSnapshotFrame* base = NULL;
+    if (client.ackedTick != 0 && server.tick - client.ackedTick < NET_SNAPSHOT_HISTORY) {
+        const NetSnapshotFrame& candidate = client.history[client.ackedTick % NET_SNAPSHOT_HISTORY];
+        if (candidate.tick == client.ackedTick) base = &candidate;
+    }
+
+    ByteWriter writer;
+    writeHeader(writer, PACKET_SNAPSHOT, client.token);
+    writer.writeU32(server.tick);
+    writer.writeU32(base ? base->tick : 0);
+    writer.writeU32(client.lastInputSequence);
+    // Own state at full wire precision for reconciliation
+    writer.writeU32(static_cast<uint32_t>(self.x));
+    writer.writeU32(static_cast<uint32_t>(self.y));
+    writer.writeU32(static_cast<uint32_t>(self.z));
+    writer.writeU32(static_cast<uint32_t>(quantizePosition(client.state.velocityY)));
+    writer.writeU8(self.flags);
+    writeSnapshotEntries(writer, frame.players, base);
+    if (writer.overflow) {
+        std::cerr << "ERROR::NET::SNAPSHOT_OVERFLOW client " << client.id << std::endl;
+        return;
+    }
+    sendToClient(server, client, writer);
+}
+
+void tickServer(NetServer& server, double now) {
+    auto start = std::chrono::steady_clock::now();
+    pollServer(server, now);
+    server.tick++;
+    const float tickDelta = 1.0f / NET_TICK_RATE;
+
+    // Apply queued inputs in sequence order, one simulation step each. Steps are budgeted at one
+    // per tick plus a few banked ones, so nobody moves faster than the tick rate allows.
+    for (auto& client : server.clients) {
+        client.stepCredits = std::min(client.stepCredits + 1, 1 + NET_MAX_CATCH_UP_STEPS);
+        size_t applied = std::min(client.pendingInputs.size(), static_cast<size_t>(client.stepCredits));
+        client.stepCredits -= static_cast<int>(applied);
+        for (size_t i = 0; i < applied; ++i) {
+            const NetQueuedInput& queued = client.pendingInputs[i];
+            simulatePlayer(client.state, queued.input, tickDelta, server.flyMode);
+            quantizeState(client.state);
+            client.lastInput = queued.input;
+            client.lastInputSequence = queued.sequence;
+        }
+        client.pendingInputs.erase(client.pendingInputs.begin(), client.pendingInputs.begin() + applied);
+    }
+
+    for (size_t i = server.clients.size(); i-- > 0;) {
+        if (now - server.clients[i].lastHeardTime > NET_TIMEOUT_SECONDS) {
+            std::cout << "[server] client " << server.clients[i].id << " timed out" << std::endl;
+            removeClient(server, i);
+        }
+    }
+
+    std::vector<NetPlayerEntry> allPlayers;
+    allPlayers.reserve(server.clients.size());
+    for (const auto& client : server.clients) allPlayers.push_back(makeEntry(client.id, client.state, client.lastInput));
+    NetRelevanceGrid grid;
+    buildRelevanceGrid(grid, allPlayers);
+    std::vector<std::pair<float, size_t>> nearest;
+    for (auto& client : server.clients) sendSnapshot(server, client, allPlayers, grid, nearest);
+
+    server.lastTickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runServer(uint16_t port, unsigned int seed, bool flyMode) {
+    if (!netStartup()) return -1;
+    NetServer server;
+    if (!startServer(server, port, seed, flyMode)) {
+        netShutdown();
+        return -1;
+    }
+    std::cout << "[server] listening on UDP port " << getSocketPort(server.socket) << ", seed " << server.seed
+              << ", fly mode " << (flyMode ? "on" : "off") << ", " << NET_TICK_RATE << " Hz" << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    const auto tickInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / NET_TICK_RATE));
+    auto startTime = Clock::now();
+    auto nextTick = startTime;
+    double tickMsSum = 0.0, tickMsMax = 0.0;
+    uint64_t bytesAtReport = 0;
+    uint32_t ticksAtReport = 0;
+    for (;;) {
+        double now = std::chrono::duration<double>(Clock::now() - startTime).count();
+        tickServer(server, now);
+        tickMsSum += server.lastTickMs;
+        tickMsMax = std::max(tickMsMax, server.lastTickMs);
+
+        // Report once per second
+        if (server.tick - ticksAtReport >= static_cast<uint32_t>(NET_TICK_RATE)) {
+            uint64_t bytesSent = 0;
+            for (const auto& client : server.clients) bytesSent += client.bytesSent;
+            double perClient = server.clients.empty() ? 0.0 : static_cast<double>(bytesSent - std::min(bytesSent, bytesAtReport)) / server.clients.size();
+            std::cout << "[server] tick " << server.tick << " | clients " << server.clients.size()
+                      << " | tick cost avg " << tickMsSum / (server.tick - ticksAtReport) << " ms, max " << tickMsMax << " ms"
+                      << " | down " << perClient / 1024.0 << " KB/s per client" << std::endl;
+            bytesAtReport = bytesSent;
+            ticksAtReport = server.tick;
+            tickMsSum = tickMsMax = 0.0;
+        }
+
+        nextTick += tickInterval;
+        if (nextTick < Clock::now()) nextTick = Clock::now(); // Overloaded: don't spiral trying to catch up
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+// --- Client ---
+
+void initNetClient(NetClient& client, UdpSocket* socket, const NetAddress& serverAddress, uint32_t token) {
+    client = NetClient();
+    client.socket = socket;
+    client.serverAddress = serverAddress;
+    client.token = token;
+}
+
+static void sendToServer(NetClient& client, const ByteWriter& writer) {
+    sendPacket(*client.socket, client.serverAddress, writer.buffer, writer.size);
+    client.bytesSent += writer.size + NET_UDP_IP_OVERHEAD;
+}
+
+void sendConnect(NetClient& client) {
+    ByteWriter writer;
+    writeHeader(writer, PACKET_CONNECT, client.token);
+    writer.writeU16(NET_PROTOCOL_VERSION);
+    sendToServer(client, writer);
+}
+
+bool connectToServer(NetClient& client, double timeoutSeconds) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    double lastSend = -1.0;
+    for (;;) {
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (elapsed > timeoutSeconds) return false;
+        if (elapsed - lastSend >= 0.25) {
+            sendConnect(client);
+            lastSend = elapsed;
+        }
+        receiveClientPackets(client, elapsed);
+        if (client.connected) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void disconnectFromServer(NetClient& client) {
+    if (!client.connected) return;
+    ByteWriter writer;
+    writeHeader(writer, PACKET_DISCONNECT, client.token);
+    sendToServer(client, writer);
+    client.connected = false;
+}
+
+static const NetSnapshotFrame* findSnapshot(const NetClient& client, uint32_t tick) {
+    for (const auto& frame : client.snapshots) {
+        if (frame.tick == tick) return &frame;
+    }
+    return NULL;
+}
+
+// Rewind to the server's state for the last input it applied and replay the rest
+static void reconcile(NetClient& client, const PlayerState& serverState, uint32_t lastInputSequence) {
+    glm::vec3 before = client.predicted.position;
+    client.predicted = serverState;
+    if (client.inputSequence - lastInputSequence < static_cast<uint32_t>(NET_INPUT_HISTORY)) {
+        const float tickDelta = 1.0f / client.tickRate;
+        for (uint32_t sequence = lastInputSequence + 1; sequence <= client.inputSequence; ++sequence) {
+            simulatePlayer(client.predicted, client.inputHistory[sequence % NET_INPUT_HISTORY], tickDelta, client.flyMode);
+            quantizeState(client.predicted);
+        }
+    }
+    glm::vec3 correction = client.predicted.position - before;
+    client.previousPredicted.position += correction; // Keep the render interpolation continuous
+    client.reconciliations++;
+    client.correctionDistanceSum += glm::length(correction);
+}
+
+bool handleClientPacket(NetClient& client, const uint8_t* data, int size, double now) {
+    ByteReader reader(data, size);
+    uint8_t type = reader.readU8();
+    if (reader.readU32() != client.token || reader.error) return false;
+    client.bytesReceived += size + NET_UDP_IP_OVERHEAD;
+    client.lastHeardTime = now;
+
+    if (type == PACKET_WELCOME) {
+        uint16_t id = reader.readU16();
+        unsigned int seed = reader.readU32();
+        bool flyMode = reader.readU8() != 0;
+        int tickRate = reader.readU8();
+        glm::vec3 spawn;
+        spawn.x = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+        spawn.y = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+        spawn.z = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+        if (reader.error || tickRate == 0) return false;
+        if (!client.connected) {
+            client.predicted.position = spawn;
+            client.previousPredicted = client.predicted;
+            client.id = id;
+            client.seed = seed;
+            client.flyMode = flyMode;
+            client.tickRate = tickRate;
+            client.connected = true;
+        }
+        return true;
+    }
+    if (type != PACKET_SNAPSHOT || !client.connected) return false;
+
+    uint32_t tick = reader.readU32();
+    uint32_t baseTick = reader.readU32();
+    uint32_t lastInputSequence = reader.readU32();
+    PlayerState serverState;
+    serverState.position.x = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+    serverState.position.y = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+    serverState.position.z = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+    serverState.velocityY = dequantizePosition(static_cast<int32_t>(reader.readU32()));
+    serverState.onGround = (reader.readU8() & 1) != 0;
+    if (reader.error || tick <= client.latestTick) return false; // Late or duplicate
+
+    const NetSnapshotFrame* base = NULL;
+    if (baseTick != 0) {
+        base = findSnapshot(client, baseTick);
+        if (!base) return false; // Baseline already dropped; the server falls back to a full snapshot once our ack ages out
+    }
+    NetSnapshotFrame frame;
+    frame.tick = tick;
+    if (!readSnapshotEntries(reader, frame.players, base)) return false;
+
+    client.snapshots.push_back(std::move(frame));
+    if (client.snapshots.size() > static_cast<size_t>(NET_SNAPSHOT_HISTORY)) client.snapshots.erase(client.snapshots.begin());
+    client.latestTick = tick;
+    client.latestSnapshotTime = now;
+    reconcile(client, serverState, lastInputSequence);
+    return true;
+}
+
+void receiveClientPackets(NetClient& client, double now) {
+    uint8_t buffer[NET_MAX_PACKET_SIZE];
+    NetAddress from;
+    int size;
+    while ((size = receivePacket(*client.socket, from, buffer, sizeof(buffer))) >= 0) {
+        if (from == client.serverAddress) handleClientPacket(client, buffer, size, now);
+    }
+    if (client.connected && now - client.lastHeardTime > NET_TIMEOUT_SECONDS) {
+        std::cerr << "ERROR::NET::SERVER_TIMEOUT " << addressToString(client.serverAddress) << std::endl;
+        client.connected = false;
+    }
+}
+
+void updateNetClient(NetClient& client, const PlayerInput& input, float deltaTime) {
+    if (!client.connected) return;
+    const float tickDelta = 1.0f / client.tickRate;
+    client.accumulator += deltaTime;
+    int steps = 0;
+    while (client.accumulator >= tickDelta && steps < 5) {
+        client.accumulator -= tickDelta;
+        steps++;
+
+        uint32_t sequence = ++client.inputSequence;
+        PlayerInput quantized = quantizeInput(input);
+        client.inputHistory[sequence % NET_INPUT_HISTORY] = quantized;
+        client.previousPredicted = client.predicted;
+        simulatePlayer(client.predicted, quantized, tickDelta, client.flyMode);
+        quantizeState(client.predicted);
+
+        ByteWriter writer;
+        writeHeader(writer, PACKET_INPUT, client.token);
+        writer.writeU32(client.latestTick);
+        writer.writeU32(sequence);
+        int count = static_cast<int>(std::min<uint32_t>(NET_INPUT_REDUNDANCY, sequence));
+        writer.writeU8(static_cast<uint8_t>(count));
+        for (int i = 0; i < count; ++i) {
+            const PlayerInput& sent = client.inputHistory[(sequence - i) % NET_INPUT_HISTORY];
+            writer.writeU8(sent.buttons);
+            writer.writeU16(quantizeYaw(sent.yaw));
+            writer.writeU16(static_cast<uint16_t>(quantizePitch(sent.pitch)));
+        }
+        sendToServer(client, writer);
+    }
+    if (steps == 5) client.accumulator = 0.0f; // Hitch: drop the backlog rather than fast-forwarding
+}
+
+glm::vec3 getPredictedEyePosition(const NetClient& client) {
+    float alpha = std::min(1.0f, client.accumulator * client.tickRate);
+    return glm::mix(client.previousPredicted.position, client.predicted.position, alpha);
+}
+
+void getRemotePlayers(const NetClient& client, double now, std::vector<NetRemotePlayer>& out) {
+    out.clear();
+    if (client.snapshots.empty()) return;
+    // Render time in ticks, a fixed delay behind the newest snapshot's clock
+    double renderTick = client.latestTick + (now - client.latestSnapshotTime) * client.tickRate - NET_INTERPOLATION_DELAY_TICKS;
+
+    size_t newer = 0;
+    while (newer < client.snapshots.size() && client.snapshots[newer].tick < renderTick) newer++;
+    if (newer == client.snapshots.size()) newer = client.snapshots.size() - 1; // Starved: hold the newest
+    const NetSnapshotFrame& to = client.snapshots[newer];
+    const NetSnapshotFrame& from = client.snapshots[newer > 0 ? newer - 1 : 0];
+    float t = (to.tick > from.tick) ? static_cast<float>((renderTick - from.tick) / (to.tick - from.tick)) : 1.0f;
+    t = std::min(1.0f, std::max(0.0f, t));
+
+    size_t fromIndex = 0;
+    for (const auto& entry : to.players) {
+        if (entry.id == client.id) continue;
+        while (fromIndex < from.players.size() && from.players[fromIndex].id < entry.id) fromIndex++;
+        const NetPlayerEntry& start = (fromIndex < from.players.size() && from.players[fromIndex].id == entry.id) ? from.players[fromIndex] : entry;
+
+        NetRemotePlayer player;
+        player.id = entry.id;
+        player.position = glm::mix(glm::vec3(dequantizePosition(start.x), dequantizePosition(start.y), dequantizePosition(start.z)),
+                                   glm::vec3(dequantizePosition(entry.x), dequantizePosition(entry.y), dequantizePosition(entry.z)), t);
+        // Shortest way round, in integers so the wrap through 0 stays defined
+        int yawDelta = static_cast<int16_t>(entry.yaw - start.yaw);
+        player.yaw = dequantizeYaw(static_cast<uint16_t>(start.yaw + static_cast<int>(std::lround(yawDelta * t))));
+        player.pitch = glm::mix(dequantizePitch(start.pitch), dequantizePitch(entry.pitch), t);
+        out.push_back(player);
+    }
+}
+
+// --- Benchmark ---
+
+void runNetBenchmark() {
+    if (!netStartup()) return;
+    const int clientCounts[] = { 1, 64, 1024 };
+    const int warmupTicks = NET_TICK_RATE;
+    const int measuredTicks = NET_TICK_RATE * 5;
+    const int maxSockets = 64;          // Simulated clients share sockets and are told apart by token
+    const int pollInterval = 64;        // Drain the server between batches so the loopback buffer never overflows
+    const float tickDelta = 1.0f / NET_TICK_RATE;
+
+    for (int clientCount : clientCounts) {
+        NetServer server;
+        if (!startServer(server, 0, 1, false)) break;
+        NetAddress serverAddress;
+        resolveAddress("127.0.0.1", getSocketPort(server.socket), serverAddress);
+
+        std::vector<UdpSocket> sockets(std::min(clientCount, maxSockets));
+        for (auto& sock : sockets) openUdpSocket(sock, 0);
+        std::vector<NetClient> bots(clientCount);
+        std::vector<PlayerInput> botInputs(clientCount);
+        std::unordered_map<uint32_t, size_t> botByToken;
+        WorldRandom random = makeWorldRandom(1, SEED_STREAM_QUERIES); // Same bots on every platform
+        for (int i = 0; i < clientCount; ++i) {
+            uint32_t token = 0x10000u + static_cast<uint32_t>(i);
+            initNetClient(bots[i], &sockets[i % sockets.size()], serverAddress, token);
+            botByToken[token] = i;
+            botInputs[i].yaw = worldRandomFloat(random) * 360.0f;
+        }
+
+        double now = 0.0;
+        auto drainBots = [&]() {
+            uint8_t buffer[NET_MAX_PACKET_SIZE];
+            NetAddress from;
+            for (auto& sock : sockets) {
+                int size;
+                while ((size = receivePacket(sock, from, buffer, sizeof(buffer))) >= 0) {
+                    ByteReader reader(buffer, size);
+                    reader.readU8();
+                    auto bot = botByToken.find(reader.readU32());
+                    if (!reader.error && bot != botByToken.end()) handleClientPacket(bots[bot->second], buffer, size, now);
+                }
+            }
+        };
+
+        // Handshake
+        for (int attempt = 0; attempt < 10; ++attempt) {
+            int pending = 0;
+            for (int i = 0; i < clientCount; ++i) {
+                if (bots[i].connected) continue;
+                sendConnect(bots[i]);
+                if (++pending % pollInterval == 0) pollServer(server, now);
+            }
+            if (pending == 0) break;
+            pollServer(server, now);
+            drainBots();
+        }
+
+        double tickMsSum = 0.0, tickMsMax = 0.0;
+        uint64_t serverSentStart = 0, serverReceivedStart = 0, snapshotsStart = 0;
+        for (int tick = 0; tick < warmupTicks + measuredTicks; ++tick) {
+            if (tick == warmupTicks) {
+                for (const auto& client : server.clients) { serverSentStart += client.bytesSent; serverReceivedStart += client.bytesReceived; }
+                for (const auto& bot : bots) snapshotsStart += bot.reconciliations;
+            }
+            now = tick * static_cast<double>(tickDelta);
+
+            // Bots wander: mostly forward, drifting yaw, occasional sprint and jump
+            double pollMs = 0.0;
+            for (int i = 0; i < clientCount; ++i) {
+                PlayerInput& input = botInputs[i];
+                input.yaw += (worldRandomFloat(random) - 0.5f) * 20.0f;
+                input.buttons = BUTTON_FORWARD;
+                if (worldRandomFloat(random) < 0.3f) input.buttons |= BUTTON_SPRINT;
+                if (worldRandomFloat(random) < 0.05f) input.buttons |= BUTTON_JUMP;
+                updateNetClient(bots[i], input, tickDelta);
+                if ((i + 1) % pollInterval == 0) {
+                    auto start = std::chrono::steady_clock::now();
+                    pollServer(server, now);
+                    pollMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+            }
+            tickServer(server, now);
+            drainBots();
+
+            if (tick >= warmupTicks) {
+                double tickMs = server.lastTickMs + pollMs;
+                tickMsSum += tickMs;
+                tickMsMax = std::max(tickMsMax, tickMs);
+            }
+        }
+
+        uint64_t serverSent = 0, serverReceived = 0, snapshots = 0;
+        double correctionSum = 0.0;
+        for (const auto& client : server.clients) { serverSent += client.bytesSent; serverReceived += client.bytesReceived; }
+        for (const auto& bot : bots) { snapshots += bot.reconciliations; correctionSum += bot.correctionDistanceSum; }
+        serverSent -= serverSentStart;
+        serverReceived -= serverReceivedStart;
+        snapshots -= snapshotsStart;
+        double seconds = measuredTicks * static_cast<double>(tickDelta);
+        double expectedSnapshots = static_cast<double>(clientCount) * measuredTicks;
+
+        std::cout << "[netbench] " << clientCount << " clients (" << server.clients.size() << " connected): "
+                  << "down " << serverSent / seconds / clientCount / 1024.0 << " KB/s per client ("
+                  << (serverSent / expectedSnapshots) << " B/snapshot incl. UDP/IP), "
+                  << "up " << serverReceived / seconds / clientCount / 1024.0 << " KB/s per client, "
+                  << "tick cost avg " << tickMsSum / measuredTicks << " ms, max " << tickMsMax << " ms, "
+                  << "snapshots received " << (100.0 * snapshots / expectedSnapshots) << "%, "
+                  << "mean prediction correction " << (snapshots ? correctionSum / snapshots : 0.0) << " m" << std::endl;
+
+        for (auto& sock : sockets) closeUdpSocket(sock);
+        stopServer(server);
+    }
+    netShutdown();
+}
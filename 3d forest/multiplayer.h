@@ -0,0 +1,146 @@
+// Authoritative multiplayer over UDP. The server runs simulatePlayer() for every client at a
+// fixed tick and sends delta-compressed, quantized snapshots; clients predict their own
+// player and interpolate everyone else. Only the world seed is sent, never geometry.
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "net.h"
+#include "player.h"
+
+// --- Multiplayer Configuration ---
+const uint16_t NET_DEFAULT_PORT = 27960;
+const uint16_t NET_PROTOCOL_VERSION = 2; // 2: worlds come from per-category seed streams, not rand()
+const int NET_TICK_RATE = 30;                 // Simulation and snapshot rate (Hz)
+const float NET_POSITION_QUANTUM = 1.0f / 256.0f; // Metres per quantized position step
+const int NET_SNAPSHOT_HISTORY = 32;          // Baselines kept for delta compression (ticks)
+const int NET_MAX_SNAPSHOT_PLAYERS = 32;      // Nearest other players per snapshot, keeps it in one datagram
+const int NET_INPUT_REDUNDANCY = 4;           // Recent inputs repeated in each input packet to ride out loss
+const int NET_MAX_PENDING_INPUTS = 8;         // Server queue per client; the oldest inputs are dropped beyond it
+const int NET_MAX_CATCH_UP_STEPS = 3;         // Steps a client may bank, beyond one per tick, to recover from late packets
+const int NET_INPUT_HISTORY = 64;             // Client inputs kept for reconciliation (ticks)
+const float NET_INTERPOLATION_DELAY_TICKS = 2.0f; // Remote players are shown this far in the past
+const double NET_TIMEOUT_SECONDS = 5.0;
+const int NET_MAX_CLIENTS = 1024;             // Connects beyond this are ignored (and time out on the client)
+const int NET_SPAWN_ATTEMPTS = 256;           // Spawn spots tried before falling back to the start position
+
+enum NetPacketType : uint8_t {
+    PACKET_CONNECT = 1,  // c->s: protocol version
+    PACKET_WELCOME,      // s->c: client id, seed, fly mode, tick rate, spawn position
+    PACKET_INPUT,        // c->s: acked snapshot tick + last NET_INPUT_REDUNDANCY inputs
+    PACKET_SNAPSHOT,     // s->c: own authoritative state + delta-compressed nearby players
+    PACKET_DISCONNECT    // c->s
+};
+
+// Quantized player as sent on the wire; deltas are taken field by field against a baseline
+struct NetPlayerEntry {
+    uint16_t id = 0;
+    int32_t x = 0, y = 0, z = 0;   // Position / NET_POSITION_QUANTUM
+    uint16_t yaw = 0;              // 0..65535 over 360 degrees
+    int16_t pitch = 0;             // Hundredths of a degree
+    uint8_t flags = 0;             // Bit 0: on ground
+};
+
+struct NetSnapshotFrame {
+    uint32_t tick = 0;
+    std::vector<NetPlayerEntry> players; // Sorted by id
+};
+
+// --- Server ---
+struct NetQueuedInput {
+    uint32_t sequence;
+    PlayerInput input;
+};
+
+struct NetServerClient {
+    uint32_t token = 0;            // Client-chosen connection token, present in every packet
+    NetAddress address;
+    uint16_t id = 0;
+    PlayerState state;
+    PlayerInput lastInput;
+    uint32_t lastInputSequence = 0;
+    uint32_t ackedTick = 0;        // Newest snapshot the client has decoded (delta baseline)
+    double lastHeardTime = 0.0;
+    std::vector<NetQueuedInput> pendingInputs; // Received but not yet simulated, oldest first
+    int stepCredits = 0;           // Simulation steps the client may still take; one is earned per tick
+    NetSnapshotFrame history[NET_SNAPSHOT_HISTORY];
+    uint64_t bytesSent = 0;        // Including UDP/IP overhead
+    uint64_t bytesReceived = 0;
+};
+
+struct NetServer {
+    UdpSocket socket;
+    unsigned int seed = 0;
+    bool flyMode = false;
+    uint32_t tick = 0;
+    uint16_t nextClientId = 1;     // Where the search for a free id starts, so ids are reused last
+    std::vector<bool> clientIdInUse = std::vector<bool>(65536, false); // One flag per uint16_t id
+    std::vector<NetServerClient> clients;
+    std::unordered_map<uint32_t, size_t> clientByToken;
+    double lastTickMs = 0.0;       // Cost of the most recent tick, receive through send
+};
+
+bool startServer(NetServer& server, uint16_t port, unsigned int seed, bool flyMode);
+void stopServer(NetServer& server);
+void pollServer(NetServer& server, double now);   // Drain the socket; tickServer() also does this
+void tickServer(NetServer& server, double now);   // Simulate one tick and send snapshots
+// Headless dedicated server loop; never returns unless the socket fails.
+int runServer(uint16_t port, unsigned int seed, bool flyMode);
+
+// --- Client ---
+struct NetRemotePlayer {
+    uint16_t id;
+    glm::vec3 position; // Eye position
+    float yaw;
+    float pitch;
+};
+
+struct NetClient {
+    UdpSocket* socket = NULL;      // Not owned; may be shared between simulated clients
+    NetAddress serverAddress;
+    uint32_t token = 0;
+    bool connected = false;
+    uint16_t id = 0;
+    unsigned int seed = 0;
+    bool flyMode = false;
+    int tickRate = NET_TICK_RATE;
+    double lastHeardTime = 0.0;    // Silence past NET_TIMEOUT_SECONDS clears `connected`
+
+    // Prediction: fixed ticks of simulatePlayer(), rendered between previous and current
+    PlayerState predicted;
+    PlayerState previousPredicted;
+    float accumulator = 0.0f;
+    uint32_t inputSequence = 0;
+    PlayerInput inputHistory[NET_INPUT_HISTORY];
+
+    // Interpolation: decoded snapshots by tick, newest last
+    std::vector<NetSnapshotFrame> snapshots;
+    uint32_t latestTick = 0;
+    double latestSnapshotTime = 0.0;
+
+    // Stats
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t reconciliations = 0;
+    double correctionDistanceSum = 0.0;
+};
+
+void initNetClient(NetClient& client, UdpSocket* socket, const NetAddress& serverAddress, uint32_t token);
+void sendConnect(NetClient& client);
+// Blocking handshake used by the windowed client before world generation.
+bool connectToServer(NetClient& client, double timeoutSeconds);
+void disconnectFromServer(NetClient& client);
+bool handleClientPacket(NetClient& client, const uint8_t* data, int size, double now);
+// Also drops the connection once the server has been silent for NET_TIMEOUT_SECONDS.
+void receiveClientPackets(NetClient& client, double now);
+// Run whole prediction ticks for the elapsed time, sending one input packet per tick.
+void updateNetClient(NetClient& client, const PlayerInput& input, float deltaTime);
+glm::vec3 getPredictedEyePosition(const NetClient& client);
+void getRemotePlayers(const NetClient& client, double now, std::vector<NetRemotePlayer>& out);
+
+// Loopback benchmark: bandwidth per client and server tick cost at several client counts.
+void runNetBenchmark();
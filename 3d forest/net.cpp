@@ -0,0 +1,121 @@
+#include "net.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib") // Link against Winsock
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+bool netStartup() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cerr << "ERROR::NET::WSASTARTUP_FAILED" << std::endl;
+        return false;
+    }
+#endif
+    return true;
+}
+
+void netShutdown() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool resolveAddress(const std::string& host, uint16_t port, NetAddress& out) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = NULL;
+    if (getaddrinfo(host.c_str(), NULL, &hints, &result) != 0 || result == NULL) {
+        std::cerr << "ERROR::NET::CANNOT_RESOLVE " << host << std::endl;
+        return false;
+    }
+    out.ip = ntohl(reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr.s_addr);
+    out.port = port;
+    freeaddrinfo(result);
+    return true;
+}
+
+std::string addressToString(const NetAddress& address) {
+    return std::to_string((address.ip >> 24) & 0xFF) + "." + std::to_string((address.ip >> 16) & 0xFF) + "." +
+           std::to_string((address.ip >> 8) & 0xFF) + "." + std::to_string(address.ip & 0xFF) + ":" + std::to_string(address.port);
+}
+
+bool openUdpSocket(UdpSocket& sock, uint16_t port) {
+    auto handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#ifdef _WIN32
+    if (handle == INVALID_SOCKET) {
+#else
+    if (handle < 0) {
+#endif
+        std::cerr << "ERROR::NET::SOCKET_CREATE_FAILED" << std::endl;
+        return false;
+    }
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    bool ok = bind(handle, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ok = ok && ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+    ok = ok && fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    sock.handle = static_cast<intptr_t>(handle);
+    if (!ok) {
+        std::cerr << "ERROR::NET::SOCKET_BIND_FAILED port " << port << std::endl;
+        closeUdpSocket(sock);
+        return false;
+    }
+    return true;
+}
+
+void closeUdpSocket(UdpSocket& sock) {
+    if (sock.handle < 0) return;
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(sock.handle));
+#else
+    close(static_cast<int>(sock.handle));
+#endif
+    sock.handle = -1;
+}
+
+uint16_t getSocketPort(const UdpSocket& sock) {
+    sockaddr_in addr = {};
+    socklen_t length = sizeof(addr);
+    if (getsockname(sock.handle, reinterpret_cast<sockaddr*>(&addr), &length) != 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+bool sendPacket(const UdpSocket& sock, const NetAddress& to, const uint8_t* data, int size) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(to.ip);
+    addr.sin_port = htons(to.port);
+    return sendto(sock.handle, reinterpret_cast<const char*>(data), size, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == size;
+}
+
+int receivePacket(const UdpSocket& sock, NetAddress& from, uint8_t* buffer, int capacity) {
+    sockaddr_in addr = {};
+    socklen_t length = sizeof(addr);
+    int received = static_cast<int>(recvfrom(sock.handle, reinterpret_cast<char*>(buffer), capacity, 0, reinterpret_cast<sockaddr*>(&addr), &length));
+    if (received < 0) return -1;
+    from.ip = ntohl(addr.sin_addr.s_addr);
+    from.port = ntohs(addr.sin_port);
+    return received;
+}
@@ -0,0 +1,71 @@
+// Minimal non-blocking UDP sockets over Winsock or BSD sockets, plus little-endian
+// byte streams with varints for packing packets.
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+const int NET_MAX_PACKET_SIZE = 1200;    // Stay under a typical path MTU
+const int NET_UDP_IP_OVERHEAD = 28;      // IPv4 + UDP header bytes per datagram, for bandwidth reports
+
+struct NetAddress {
+    uint32_t ip = 0;    // Host byte order
+    uint16_t port = 0;  // Host byte order
+};
+inline bool operator==(const NetAddress& a, const NetAddress& b) { return a.ip == b.ip && a.port == b.port; }
+
+struct UdpSocket {
+    intptr_t handle = -1;
+};
+
+bool netStartup();   // WSAStartup on Windows, no-op elsewhere
+void netShutdown();
+bool resolveAddress(const std::string& host, uint16_t port, NetAddress& out);
+std::string addressToString(const NetAddress& address);
+
+// Binds to all interfaces on `port` (0 = ephemeral) in non-blocking mode.
+bool openUdpSocket(UdpSocket& sock, uint16_t port);
+void closeUdpSocket(UdpSocket& sock);
+uint16_t getSocketPort(const UdpSocket& sock);
+bool sendPacket(const UdpSocket& sock, const NetAddress& to, const uint8_t* data, int size);
+// Returns the datagram size, or -1 when nothing is waiting.
+int receivePacket(const UdpSocket& sock, NetAddress& from, uint8_t* buffer, int capacity);
+
+// --- Byte Streams ---
+struct ByteWriter {
+    uint8_t buffer[NET_MAX_PACKET_SIZE];
+    int size = 0;
+    bool overflow = false;
+
+    void writeU8(uint8_t v) { if (size + 1 > NET_MAX_PACKET_SIZE) { overflow = true; return; } buffer[size++] = v; }
+    void writeU16(uint16_t v) { writeU8(static_cast<uint8_t>(v)); writeU8(static_cast<uint8_t>(v >> 8)); }
+    void writeU32(uint32_t v) { writeU16(static_cast<uint16_t>(v)); writeU16(static_cast<uint16_t>(v >> 16)); }
+    void writeVarU32(uint32_t v) { while (v >= 0x80) { writeU8(static_cast<uint8_t>(v | 0x80)); v >>= 7; } writeU8(static_cast<uint8_t>(v)); }
+    // Zigzag keeps small negative deltas small
+    void writeVarS32(int32_t v) { writeVarU32((static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31)); }
+};
+
+struct ByteReader {
+    const uint8_t* data;
+    int size;
+    int offset = 0;
+    bool error = false;
+
+    ByteReader(const uint8_t* d, int s) : data(d), size(s) {}
+    uint8_t readU8() { if (offset + 1 > size) { error = true; return 0; } return data[offset++]; }
+    uint16_t readU16() { uint16_t lo = readU8(); return static_cast<uint16_t>(lo | (readU8() << 8)); }
+    uint32_t readU32() { uint32_t lo = readU16(); return lo | (static_cast<uint32_t>(readU16()) << 16); }
+    uint32_t readVarU32() {
+        uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            uint8_t b = readU8();
+            v |= static_cast<uint32_t>(b & 0x7F) << shift;
+            if (!(b & 0x80) || error) return v;
+        }
+        error = true;
+        return 0;
+    }
+    int32_t readVarS32() { uint32_t v = readVarU32(); return static_cast<int32_t>((v >> 1) ^ (~(v & 1) + 1)); }
+};
@@ -0,0 +1,102 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "player.h"
+
+#include <glm/gtx/norm.hpp> // For glm::length2
+
+#include <cmath>
+
+glm::vec3 cameraFrontFromAngles(float yaw, float pitch) {
+    glm::vec3 front;
+    front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+    front.y = sin(glm::radians(pitch));
+    front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+    return glm::normalize(front);
+}
+
+void applyMouseLook(float xoffset, float yoffset, float& yaw, float& pitch, glm::vec3& front, glm::vec3& up) {
+    yaw += xoffset * MOUSE_SENSITIVITY;
+    pitch += yoffset * MOUSE_SENSITIVITY;
+    if (pitch > 89.0f) pitch = 89.0f;
+    if (pitch < -89.0f) pitch = -89.0f;
+    front = cameraFrontFromAngles(yaw, pitch);
+    // Recalculate up to prevent roll issues, especially in fly mode
+    glm::vec3 worldUp = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 right = glm::normalize(glm::cross(front, worldUp));
+    up = glm::normalize(glm::cross(right, front));
+}
+
+void simulatePlayer(PlayerState& state, const PlayerInput& input, float deltaTime, bool flyMode) {
+    // --- Speed Calculation ---
+    float currentSpeed = PLAYER_BASE_SPEED;
+    if (input.buttons & BUTTON_SPRINT) {
+        currentSpeed *= SPRINT_MULTIPLIER;
+    }
+
+    // --- Horizontal/Forward Movement Direction ---
+    glm::vec3 moveDir(0.0f);
+    // In fly mode, use the full view direction for movement
+    // In normal mode, only use the XZ components for ground movement
+    glm::vec3 cameraFront = cameraFrontFromAngles(input.yaw, input.pitch);
+    glm::vec3 forward = flyMode ? cameraFront : glm::normalize(glm::vec3(cameraFront.x, 0.0f, cameraFront.z));
+    glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f))); // Right is always perpendicular to world up
+
+    if (input.buttons & BUTTON_FORWARD) moveDir += forward;
+    if (input.buttons & BUTTON_BACK) moveDir -= forward;
+    if (input.buttons & BUTTON_LEFT) moveDir -= right;
+    if (input.buttons & BUTTON_RIGHT) moveDir += right;
+
+    // Normalize moveDir if there's movement
+    if (glm::length2(moveDir) > 0.0001f) {
+        moveDir = glm::normalize(moveDir);
+    }
+
+    glm::vec3 deltaMove = moveDir * currentSpeed * deltaTime;
+
+    // --- Apply Movement & Handle Physics/Collisions based on Mode ---
+    if (flyMode) {
+        // --- Fly Mode ---
+        // No gravity, no ground check, no collision detection
+        state.position += deltaMove;
+        if (input.buttons & BUTTON_JUMP) {
+            state.position.y += FLY_VERTICAL_SPEED * deltaTime;
+        }
+        if (input.buttons & BUTTON_DESCEND) {
+            state.position.y -= FLY_VERTICAL_SPEED * deltaTime;
+        }
+        state.onGround = false; // Not on ground when flying
+        state.velocityY = 0.0f; // Reset vertical velocity
+    }
+    else {
+        // --- Normal (Walk/Jump) Mode ---
+        // Collision Detection & Resolution (Simple Slide): try X, then Z from the possibly updated X
+        glm::vec3 nextPosX = state.position;
+        nextPosX.x += deltaMove.x;
+        if (!checkCollision(nextPosX)) {
+            state.position.x = nextPosX.x;
+        }
+        glm::vec3 nextPosZ = state.position;
+        nextPosZ.z += deltaMove.z;
+        if (!checkCollision(nextPosZ)) {
+            state.position.z = nextPosZ.z;
+        }
+
+        // --- Vertical Movement (Gravity & Jump) ---
+        state.velocityY -= GRAVITY * deltaTime;
+        if ((input.buttons & BUTTON_JUMP) && state.onGround) {
+            state.velocityY = JUMP_FORCE;
+            state.onGround = false; // Prevent holding space for continuous jumping
+        }
+
+        // Ground collision check (before applying vertical movement)
+        float nextY = state.position.y + state.velocityY * deltaTime;
+        if (nextY - PLAYER_EYE_HEIGHT <= GROUND_LEVEL) {
+            state.position.y = GROUND_LEVEL + PLAYER_EYE_HEIGHT; // Snap to ground
+            state.velocityY = 0.0f; // Stop falling
+            state.onGround = true;  // Allow jumping again
+        }
+        else {
+            state.position.y = nextY;
+            state.onGround = false; // Player is in the air
+        }
+    }
+}
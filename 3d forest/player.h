@@ -0,0 +1,42 @@
+// Player movement (walk/jump physics with collision, or fly mode) as a pure step function,
+// shared by the local game loop, the multiplayer server and client-side prediction.
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+#include "world.h"
+
+// Held keys, one bit each
+enum PlayerButton : uint8_t {
+    BUTTON_FORWARD = 1 << 0,
+    BUTTON_BACK = 1 << 1,
+    BUTTON_LEFT = 1 << 2,
+    BUTTON_RIGHT = 1 << 3,
+    BUTTON_JUMP = 1 << 4,    // Jump when walking, ascend when flying
+    BUTTON_DESCEND = 1 << 5, // Fly mode only
+    BUTTON_SPRINT = 1 << 6
+};
+
+struct PlayerInput {
+    uint8_t buttons = 0;
+    float yaw = -90.0f;  // Degrees, as accumulated by mouse_callback
+    float pitch = 0.0f;  // Degrees, clamped to +-89
+};
+
+struct PlayerState {
+    glm::vec3 position = glm::vec3(0.0f, GROUND_LEVEL + PLAYER_EYE_HEIGHT, 3.0f); // Eye position
+    float velocityY = 0.0f;
+    bool onGround = true;
+};
+
+const float MOUSE_SENSITIVITY = 0.1f; // Degrees per pixel of cursor motion
+
+// Unit view direction for the given angles (same math as mouse_callback)
+glm::vec3 cameraFrontFromAngles(float yaw, float pitch);
+// Turn by a cursor delta in pixels (y up), clamping pitch to +-89, and rebuild the camera basis.
+void applyMouseLook(float xoffset, float yoffset, float& yaw, float& pitch, glm::vec3& front, glm::vec3& up);
+
+// Advance one step of deltaTime seconds. Walk mode applies gravity, jumping and
+// collision against checkCollision(); fly mode moves freely.
+void simulatePlayer(PlayerState& state, const PlayerInput& input, float deltaTime, bool flyMode);
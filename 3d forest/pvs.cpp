@@ -0,0 +1,551 @@
+#include "pvs.h"
+#include "world_graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+const float PVS_EYE_LOW = GROUND_LEVEL + PLAYER_EYE_HEIGHT;
+const float PVS_EYE_HIGH = PVS_EYE_LOW + PVS_MAX_EYE_RISE;
+const int PVS_TARGET_POINTS = 9; // Center and corners of a target's bounds
+const int PVS_MAX_EYES = 2 * PVS_EYE_SAMPLES_PER_SIDE * PVS_EYE_SAMPLES_PER_SIDE + 2;
+
+// --- Snapshot ---
+// Interleaves the low 16 bits of v with zeros
+static uint32_t spreadMortonBits(uint32_t v) {
+    v &= 0xffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+static uint32_t targetMortonKey(const PvsTarget& target) {
+    glm::vec3 center = (target.boundsMin + target.boundsMax) * 0.5f;
+    uint32_t x = static_cast<uint32_t>(glm::clamp(center.x / PVS_CELL_SIZE + 32768.0f, 0.0f, 65535.0f));
+    uint32_t z = static_cast<uint32_t>(glm::clamp(center.z / PVS_CELL_SIZE + 32768.0f, 0.0f, 65535.0f));
+    return spreadMortonBits(x) | (spreadMortonBits(z) << 1);
+}
+
+void preparePvsInput(PvsInput& input, const WorldInstances& instances) {
+    RayScene scene;
+    buildRayScene(scene, PVS_OCCLUDER_TYPES);
+    input.occluders = scene.primitives;
+    input.targets.clear();
+    input.targetSlots.clear();
+    input.alwaysVisibleSlots.clear();
+    input.slotCount = static_cast<uint32_t>(instances.parts.size());
+    input.liveSlots = 0;
+    for (uint8_t alive : instances.alive) input.liveSlots += alive;
+
+    for (int type = 0; type < OBJECT_TYPE_COUNT; ++type) {
+        const ArenaVector<uint32_t>& slots = instances.objectSlots[type];
+        if (type == OBJECT_GROUND || type == OBJECT_SUN) {
+            input.alwaysVisibleSlots.insert(input.alwaysVisibleSlots.end(), slots.begin(), slots.end());
+            continue;
+        }
+        size_t perObject = WORLD_OBJECT_PART_COUNTS[type];
+        for (size_t first = 0; first + perObject <= slots.size(); first += perObject) {
+            PvsTarget target;
+            target.boundsMin = glm::vec3(INFINITY);
+            target.boundsMax = glm::vec3(-INFINITY);
+            target.firstSlot = static_cast<uint32_t>(input.targetSlots.size());
+            target.slotCount = static_cast<uint32_t>(perObject);
+            for (size_t p = first; p < first + perObject; ++p) {
+                const WorldPart& part = instances.parts[slots[p]];
+                target.boundsMin = glm::min(target.boundsMin, part.center - part.size * 0.5f);
+                target.boundsMax = glm::max(target.boundsMax, part.center + part.size * 0.5f);
+                input.targetSlots.push_back(slots[p]);
+            }
+            input.targets.push_back(target);
+        }
+    }
+    std::sort(input.targets.begin(), input.targets.end(), [](const PvsTarget& a, const PvsTarget& b) {
+        return targetMortonKey(a) < targetMortonKey(b);
+    });
+}
+
+// --- Bitset Encoding ---
+static bool isFillWord(uint64_t word) {
+    return word == 0 || word == ~0ull;
+}
+
+static void encodePvsBits(const std::vector<uint64_t>& bits, std::vector<uint64_t>& out) {
+    size_t i = 0;
+    while (i < bits.size()) {
+        bool fillBit = bits[i] == ~0ull;
+        uint64_t fill = fillBit ? ~0ull : 0;
+        uint64_t run = 0, literals = 0;
+        while (i < bits.size() && bits[i] == fill && run < 0x7fffffffu) { ++run; ++i; }
+        size_t marker = out.size();
+        out.push_back(0);
+        while (i < bits.size() && !isFillWord(bits[i]) && literals < 0xffffffffu) { out.push_back(bits[i]); ++literals; ++i; }
+        out[marker] = (fillBit ? 1ull << 63 : 0) | (run << 32) | literals;
+    }
+}
+
+static void setSlotBit(std::vector<uint64_t>& slotBits, uint32_t slot) {
+    slotBits[slot / 64] |= 1ull << (slot % 64);
+}
+
+static bool testSlotBit(const std::vector<uint64_t>& slotBits, uint32_t slot) {
+    return slot / 64 < slotBits.size() && ((slotBits[slot / 64] >> (slot % 64)) & 1) != 0;
+}
+
+static void setTargetSlotBits(const PvsGrid& grid, size_t target, std::vector<uint64_t>& slotBits) {
+    if (target >= grid.targets.size()) return; // Padding bits of the last word
+    const PvsTarget& t = grid.targets[target];
+    for (uint32_t s = t.firstSlot; s < t.firstSlot + t.slotCount; ++s) setSlotBit(slotBits, grid.targetSlots[s]);
+}
+
+void decodePvsCell(const PvsGrid& grid, int cell, std::vector<uint64_t>& slotBits) {
+    slotBits.assign((grid.slotCount + 63) / 64, 0);
+    for (uint32_t slot : grid.alwaysVisibleSlots) setSlotBit(slotBits, slot);
+    size_t target = 0;
+    for (uint32_t k = grid.cellOffsets[cell]; k < grid.cellOffsets[cell + 1];) {
+        uint64_t marker = grid.words[k++];
+        size_t run = static_cast<size_t>((marker >> 32) & 0x7fffffffu);
+        size_t literals = static_cast<size_t>(marker & 0xffffffffu);
+        if (marker >> 63) {
+            for (size_t t = target; t < target + run * 64; ++t) setTargetSlotBits(grid, t, slotBits);
+        }
+        target += run * 64;
+        for (size_t l = 0; l < literals; ++l, target += 64) {
+            uint64_t word = grid.words[k++];
+            for (int bit = 0; bit < 64; ++bit) {
+                if ((word >> bit) & 1) setTargetSlotBits(grid, target + bit, slotBits);
+            }
+        }
+    }
+}
+
+// --- Build ---
+// Occluders bucketed by the PVS cells their footprint overlaps
+struct PvsOccluderGrid {
+    std::vector<uint32_t> cellStart; // cellsX * cellsZ + 1, into indices
+    std::vector<uint32_t> indices;
+};
+
+static int pvsCellIndex(const PvsGrid& grid, int x, int z) {
+    return (x < 0 || z < 0 || x >= grid.cellsX || z >= grid.cellsZ) ? -1 : z * grid.cellsX + x;
+}
+
+static void buildOccluderGrid(const PvsGrid& grid, const std::vector<RayPrimitive>& occluders, PvsOccluderGrid& occluderGrid) {
+    std::vector<std::vector<uint32_t>> buckets(static_cast<size_t>(grid.cellsX) * grid.cellsZ);
+    for (size_t i = 0; i < occluders.size(); ++i) {
+        glm::vec2 lo = (glm::vec2(occluders[i].boundsMin.x, occluders[i].boundsMin.z) - grid.origin) / PVS_CELL_SIZE;
+        glm::vec2 hi = (glm::vec2(occluders[i].boundsMax.x, occluders[i].boundsMax.z) - grid.origin) / PVS_CELL_SIZE;
+        for (int z = static_cast<int>(std::floor(lo.y)); z <= static_cast<int>(std::floor(hi.y)); ++z) {
+            for (int x = static_cast<int>(std::floor(lo.x)); x <= static_cast<int>(std::floor(hi.x)); ++x) {
+                int cell = pvsCellIndex(grid, x, z);
+                if (cell >= 0) buckets[cell].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+    occluderGrid.cellStart.clear();
+    occluderGrid.indices.clear();
+    for (const auto& bucket : buckets) {
+        occluderGrid.cellStart.push_back(static_cast<uint32_t>(occluderGrid.indices.size()));
+        occluderGrid.indices.insert(occluderGrid.indices.end(), bucket.begin(), bucket.end());
+    }
+    occluderGrid.cellStart.push_back(static_cast<uint32_t>(occluderGrid.indices.size()));
+}
+
+static bool containsPoint(glm::vec3 boundsMin, glm::vec3 boundsMax, glm::vec3 point) {
+    return point.x >= boundsMin.x && point.y >= boundsMin.y && point.z >= boundsMin.z &&
+           point.x <= boundsMax.x && point.y <= boundsMax.y && point.z <= boundsMax.z;
+}
+
+// Slab test of the segment from..to against a box
+static bool segmentHitsBox(glm::vec3 from, glm::vec3 to, glm::vec3 boundsMin, glm::vec3 boundsMax) {
+    glm::vec3 direction = to - from;
+    float tEnter = 0.0f, tExit = 1.0f;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (std::abs(direction[axis]) < 1e-8f) {
+            if (from[axis] < boundsMin[axis] || from[axis] > boundsMax[axis]) return false;
+            continue;
+        }
+        float t1 = (boundsMin[axis] - from[axis]) / direction[axis];
+        float t2 = (boundsMax[axis] - from[axis]) / direction[axis];
+        tEnter = std::max(tEnter, std::min(t1, t2));
+        tExit = std::min(tExit, std::max(t1, t2));
+        if (tEnter > tExit) return false;
+    }
+    return true;
+}
+
+// Everything one worker needs to test a cell's targets
+struct PvsCellContext {
+    const PvsGrid* grid;
+    const PvsInput* input;
+    const PvsOccluderGrid* occluderGrid;
+    std::vector<uint32_t> occluderStamps; // Last target each occluder was tried for
+    uint32_t stamp = 0;
+    glm::vec3 eyes[PVS_MAX_EYES];
+    size_t eyeCount = 0;
+    size_t rays = 0;
+};
+
+// Eye samples over the cell grown by the margin, at eye height and at the top of a jump, minus
+// those inside an occluder (nobody stands there). The center comes first.
+static void getCellEyes(PvsCellContext& context, glm::vec2 cellMin) {
+    glm::vec3 candidates[PVS_MAX_EYES];
+    size_t count = 0;
+    glm::vec2 center = cellMin + glm::vec2(PVS_CELL_SIZE * 0.5f);
+    float heights[2] = { PVS_EYE_LOW, PVS_EYE_HIGH };
+    for (float y : heights) candidates[count++] = glm::vec3(center.x, y, center.y);
+    float span = PVS_CELL_SIZE + 2.0f * PVS_MARGIN;
+    for (int z = 0; z < PVS_EYE_SAMPLES_PER_SIDE; ++z) {
+        for (int x = 0; x < PVS_EYE_SAMPLES_PER_SIDE; ++x) {
+            glm::vec2 xz = cellMin - glm::vec2(PVS_MARGIN) + glm::vec2(x, z) * (span / (PVS_EYE_SAMPLES_PER_SIDE - 1));
+            if (glm::length(xz - center) < 1e-3f) continue;
+            for (float y : heights) candidates[count++] = glm::vec3(xz.x, y, xz.y);
+        }
+    }
+
+    const PvsGrid& grid = *context.grid;
+    const PvsOccluderGrid& occluderGrid = *context.occluderGrid;
+    context.eyeCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 eye = candidates[i];
+        int cell = pvsCellIndex(grid, static_cast<int>(std::floor((eye.x - grid.origin.x) / PVS_CELL_SIZE)),
+                                static_cast<int>(std::floor((eye.z - grid.origin.y) / PVS_CELL_SIZE)));
+        bool inside = false;
+        if (cell >= 0) {
+            for (uint32_t k = occluderGrid.cellStart[cell]; k < occluderGrid.cellStart[cell + 1] && !inside; ++k) {
+                const RayPrimitive& occluder = context.input->occluders[occluderGrid.indices[k]];
+                inside = containsPoint(occluder.boundsMin, occluder.boundsMax, eye);
+            }
+        }
+        if (!inside) context.eyes[context.eyeCount++] = eye;
+    }
+}
+
+// True when a single occluder, shrunk by the margin, cuts every segment from every eye sample to
+// the target's center and corners. Targets hidden only by several occluders together are kept.
+static bool occluderHidesTarget(PvsCellContext& context, const RayPrimitive& occluder, const PvsTarget& target, const glm::vec3* points) {
+    // A house or tower is not hidden by its own body
+    if (containsPoint(target.boundsMin, target.boundsMax, occluder.boundsMin) && containsPoint(target.boundsMin, target.boundsMax, occluder.boundsMax)) return false;
+    glm::vec3 shrunkMin = occluder.boundsMin + glm::vec3(PVS_MARGIN), shrunkMax = occluder.boundsMax - glm::vec3(PVS_MARGIN);
+    for (size_t e = 0; e < context.eyeCount; ++e) {
+        for (int p = 0; p < PVS_TARGET_POINTS; ++p) {
+            context.rays++;
+            if (!segmentHitsBox(context.eyes[e], points[p], shrunkMin, shrunkMax)) return false;
+        }
+    }
+    return true;
+}
+
+// An occluder hiding the target must cut the segment from the first eye to the target's center,
+// so only the occluders in the cells along it are tried (a 2D DDA walk over the grid).
+static bool isTargetHidden(PvsCellContext& context, const PvsTarget& target) {
+    if (context.eyeCount == 0) return false;
+    glm::vec3 points[PVS_TARGET_POINTS];
+    points[0] = (target.boundsMin + target.boundsMax) * 0.5f;
+    for (int corner = 0; corner < 8; ++corner) {
+        points[corner + 1] = glm::vec3(corner & 1 ? target.boundsMax.x : target.boundsMin.x,
+                                       corner & 2 ? target.boundsMax.y : target.boundsMin.y,
+                                       corner & 4 ? target.boundsMax.z : target.boundsMin.z);
+    }
+
+    const PvsGrid& grid = *context.grid;
+    const PvsOccluderGrid& occluderGrid = *context.occluderGrid;
+    context.stamp++;
+    glm::vec2 from = (glm::vec2(context.eyes[0].x, context.eyes[0].z) - grid.origin) / PVS_CELL_SIZE;
+    glm::vec2 to = (glm::vec2(points[0].x, points[0].z) - grid.origin) / PVS_CELL_SIZE;
+    glm::vec2 delta = to - from;
+    int x = static_cast<int>(std::floor(from.x)), z = static_cast<int>(std::floor(from.y));
+    int endX = static_cast<int>(std::floor(to.x)), endZ = static_cast<int>(std::floor(to.y));
+    int stepX = delta.x > 0.0f ? 1 : -1, stepZ = delta.y > 0.0f ? 1 : -1;
+    float tMaxX = delta.x != 0.0f ? ((x + (stepX > 0 ? 1 : 0)) - from.x) / delta.x : INFINITY;
+    float tMaxZ = delta.y != 0.0f ? ((z + (stepZ > 0 ? 1 : 0)) - from.y) / delta.y : INFINITY;
+    float tDeltaX = delta.x != 0.0f ? std::abs(1.0f / delta.x) : INFINITY;
+    float tDeltaZ = delta.y != 0.0f ? std::abs(1.0f / delta.y) : INFINITY;
+    for (int steps = std::abs(endX - x) + std::abs(endZ - z); steps >= 0; --steps) {
+        int cell = pvsCellIndex(grid, x, z);
+        for (uint32_t k = cell >= 0 ? occluderGrid.cellStart[cell] : 0; cell >= 0 && k < occluderGrid.cellStart[cell + 1]; ++k) {
+            uint32_t index = occluderGrid.indices[k];
+            if (context.occluderStamps[index] == context.stamp) continue;
+            context.occluderStamps[index] = context.stamp;
+            if (occluderHidesTarget(context, context.input->occluders[index], target, points)) return true;
+        }
+        if (tMaxX < tMaxZ) { x += stepX; tMaxX += tDeltaX; }
+        else { z += stepZ; tMaxZ += tDeltaZ; }
+    }
+    return false;
+}
+
+static void buildPvsCell(PvsCellContext& context, int cell, std::vector<uint64_t>& bits, std::vector<uint64_t>& encoded, size_t& visibleSlots) {
+    const PvsGrid& grid = *context.grid;
+    const PvsInput& input = *context.input;
+    std::fill(bits.begin(), bits.end(), 0);
+    visibleSlots = input.alwaysVisibleSlots.size();
+
+    glm::vec2 cellMin = grid.origin + glm::vec2(cell % grid.cellsX, cell / grid.cellsX) * PVS_CELL_SIZE;
+    glm::vec2 nearMin = cellMin - glm::vec2(PVS_MARGIN), nearMax = cellMin + glm::vec2(PVS_CELL_SIZE + PVS_MARGIN);
+    getCellEyes(context, cellMin);
+    for (size_t t = 0; t < input.targets.size(); ++t) {
+        const PvsTarget& target = input.targets[t];
+        // Targets reaching into the sampled area are always in
+        bool nearby = target.boundsMax.x >= nearMin.x && target.boundsMin.x <= nearMax.x &&
+                      target.boundsMax.z >= nearMin.y && target.boundsMin.z <= nearMax.y;
+        if (!nearby && isTargetHidden(context, target)) continue;
+        bits[t / 64] |= 1ull << (t % 64);
+        visibleSlots += target.slotCount;
+    }
+    encoded.clear();
+    encodePvsBits(bits, encoded);
+}
+
+bool buildPvs(PvsGrid& grid, const PvsInput& input, unsigned int threadCount, const std::atomic<bool>* cancel) {
+    auto start = std::chrono::steady_clock::now();
+    grid = PvsGrid();
+    grid.slotCount = input.slotCount;
+    grid.targets = input.targets;
+    grid.targetSlots = input.targetSlots;
+    grid.alwaysVisibleSlots = input.alwaysVisibleSlots;
+
+    // Cover the ground and every object, in whole cells
+    glm::vec2 worldMin(-GROUND_SIZE / 2.0f), worldMax(GROUND_SIZE / 2.0f);
+    for (const PvsTarget& target : input.targets) {
+        worldMin = glm::min(worldMin, glm::vec2(target.boundsMin.x, target.boundsMin.z));
+        worldMax = glm::max(worldMax, glm::vec2(target.boundsMax.x, target.boundsMax.z));
+    }
+    grid.origin = worldMin;
+    grid.cellsX = static_cast<int>(std::ceil((worldMax.x - worldMin.x) / PVS_CELL_SIZE));
+    grid.cellsZ = static_cast<int>(std::ceil((worldMax.y - worldMin.y) / PVS_CELL_SIZE));
+    int cellCount = grid.cellsX * grid.cellsZ;
+    PvsOccluderGrid occluderGrid;
+    buildOccluderGrid(grid, input.occluders, occluderGrid);
+
+    // Workers pull cells; each cell's encoding is kept apart and concatenated in order after
+    std::vector<std::vector<uint64_t>> cellWords(cellCount);
+    std::vector<size_t> cellVisible(cellCount);
+    std::atomic<int> nextCell(0);
+    std::atomic<size_t> totalRays(0);
+    auto worker = [&]() {
+        PvsCellContext context;
+        context.grid = &grid;
+        context.input = &input;
+        context.occluderGrid = &occluderGrid;
+        context.occluderStamps.assign(input.occluders.size(), 0);
+        std::vector<uint64_t> bits((input.targets.size() + 63) / 64);
+        for (int cell = nextCell.fetch_add(1); cell < cellCount; cell = nextCell.fetch_add(1)) {
+            if (cancel && cancel->load()) break;
+            buildPvsCell(context, cell, bits, cellWords[cell], cellVisible[cell]);
+        }
+        totalRays += context.rays;
+    };
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, std::max(1, cellCount)));
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned int t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+    if (cancel && cancel->load()) return false;
+
+    grid.cellOffsets.reserve(cellCount + 1);
+    size_t visibleSum = 0;
+    for (int cell = 0; cell < cellCount; ++cell) {
+        grid.cellOffsets.push_back(static_cast<uint32_t>(grid.words.size()));
+        grid.words.insert(grid.words.end(), cellWords[cell].begin(), cellWords[cell].end());
+        visibleSum += cellVisible[cell];
+        grid.stats.maxVisibleSlots = std::max(grid.stats.maxVisibleSlots, cellVisible[cell]);
+    }
+    grid.cellOffsets.push_back(static_cast<uint32_t>(grid.words.size()));
+
+    grid.stats.rays = totalRays;
+    grid.stats.threads = threadCount;
+    grid.stats.compressedBytes = grid.words.size() * sizeof(uint64_t) + grid.cellOffsets.size() * sizeof(uint32_t);
+    grid.stats.rawBytes = static_cast<size_t>(cellCount) * ((input.targets.size() + 63) / 64) * sizeof(uint64_t);
+    grid.stats.liveSlots = input.liveSlots;
+    grid.stats.averageVisibleSlots = cellCount > 0 ? static_cast<double>(visibleSum) / cellCount : 0.0;
+    grid.stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    grid.valid = true;
+    return true;
+}
+
+int findPvsCell(const PvsGrid& grid, glm::vec3 eye) {
+    if (!grid.valid || eye.y > PVS_EYE_HIGH + PVS_MARGIN) return -1;
+    return pvsCellIndex(grid, static_cast<int>(std::floor((eye.x - grid.origin.x) / PVS_CELL_SIZE)),
+                        static_cast<int>(std::floor((eye.z - grid.origin.y) / PVS_CELL_SIZE)));
+}
+
+void printPvsReport(const PvsGrid& grid) {
+    const PvsBuildStats& stats = grid.stats;
+    double kib = 1024.0;
+    double reduction = stats.liveSlots > 0 ? 100.0 * (1.0 - stats.averageVisibleSlots / stats.liveSlots) : 0.0;
+    std::streamsize oldPrecision = std::cout.precision(1);
+    std::ios::fmtflags oldFlags = std::cout.setf(std::ios::fixed, std::ios::floatfield);
+    std::cout << "PVS: " << grid.cellsX << " x " << grid.cellsZ << " cells of " << PVS_CELL_SIZE << " m built in " << stats.buildMs
+              << " ms (" << stats.rays / 1e6 << "M rays on " << stats.threads << " threads), " << stats.compressedBytes / kib
+              << " KiB compressed (" << stats.rawBytes / kib << " KiB as plain bitsets), draws per cell avg " << stats.averageVisibleSlots
+              << " / max " << stats.maxVisibleSlots << " of " << stats.liveSlots << " (" << reduction << "% fewer on average)" << std::endl;
+    std::cout.precision(oldPrecision);
+    std::cout.flags(oldFlags);
+}
+
+// --- Background Build and Runtime State ---
+// The ray object a part belongs to in buildRayScene(), to test against PVS_OCCLUDER_TYPES
+static bool isPvsOccluderPart(WorldPartType type) {
+    RayObjectType object = RAY_OBJECT_NONE;
+    switch (type) {
+    case PART_TREE_TRUNK: object = RAY_OBJECT_TREE; break;
+    case PART_HOUSE_BODY:
+    case PART_HOUSE_ROOF:
+    case PART_HOUSE_DOOR:
+    case PART_HOUSE_WINDOW: object = RAY_OBJECT_HOUSE; break;
+    case PART_TOWER: object = RAY_OBJECT_TOWER; break;
+    case PART_BALCONY_FLOOR:
+    case PART_BALCONY_RAILING: object = RAY_OBJECT_BALCONY; break;
+    default: break;
+    }
+    return object != RAY_OBJECT_NONE && (PVS_OCCLUDER_TYPES & (1u << object)) != 0;
+}
+
+static void addEditedSlots(PvsState& state) {
+    if (state.visible.size() < state.editedSlots.size()) state.visible.resize(state.editedSlots.size(), 0);
+    for (size_t i = 0; i < state.editedSlots.size(); ++i) state.visible[i] |= state.editedSlots[i];
+}
+
+static void stopPvsBuild(PvsBackgroundBuild& build) {
+    if (!build.running) return;
+    build.cancel = true;
+    build.thread.join();
+    build.running = false;
+}
+
+static void startPvsBuild(PvsBackgroundBuild& build, const WorldInstances& instances) {
+    preparePvsInput(build.input, instances);
+    build.done = false;
+    build.cancel = false;
+    build.running = true;
+    // Leave a core to the render thread
+    unsigned int threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    build.thread = std::thread([&build, threads]() {
+        buildPvs(build.result, build.input, threads, &build.cancel);
+        build.done = true;
+    });
+}
+
+// Also snapshots which slots hold occluders, so removing one is noticed even if its slot is
+// reused in the same frame
+static void startPvsStateBuild(PvsState& state, const WorldInstances& instances) {
+    state.occluderSlots.assign((instances.parts.size() + 63) / 64, 0);
+    for (size_t slot = 0; slot < instances.parts.size(); ++slot) {
+        if (instances.alive[slot] && isPvsOccluderPart(instances.parts[slot].type)) setSlotBit(state.occluderSlots, static_cast<uint32_t>(slot));
+    }
+    state.editedSlots.clear();
+    startPvsBuild(state.build, instances);
+}
+
+void invalidatePvs(PvsState& state, double now) {
+    stopPvsBuild(state.build);
+    state.grid.valid = false;
+    state.worldChangedTime = now;
+}
+
+bool updatePvs(PvsState& state, const WorldInstances& instances, glm::vec3 eye, bool flying, double now) {
+    if (!state.grid.valid) {
+        if (state.build.running && state.build.done) {
+            state.build.thread.join();
+            state.build.running = false;
+            std::swap(state.grid, state.build.result);
+            printPvsReport(state.grid);
+        }
+        else if (!state.build.running && now - state.worldChangedTime >= PVS_REBUILD_DELAY_SECONDS) {
+            startPvsStateBuild(state, instances);
+        }
+    }
+
+    int cell = flying ? -1 : findPvsCell(state.grid, eye);
+    if (cell == state.cell) return false;
+    state.cell = cell;
+    if (cell >= 0) {
+        decodePvsCell(state.grid, cell, state.visible);
+        addEditedSlots(state);
+    }
+    return true;
+}
+
+bool updatePvsEdits(PvsState& state, const WorldInstances& instances, const std::vector<InstanceRange>& dirtyRanges, double now) {
+    if (dirtyRanges.empty()) return false;
+    for (const InstanceRange& range : dirtyRanges) {
+        for (uint32_t slot = range.first; slot < range.first + range.count; ++slot) {
+            if (testSlotBit(state.occluderSlots, slot) || isPvsOccluderPart(instances.parts[slot].type)) {
+                invalidatePvs(state, now);
+                return false; // updatePvs() drops the cell
+            }
+        }
+    }
+    // Slots past the last build's count only exist through edits, so this covers all of them
+    size_t words = (instances.parts.size() + 63) / 64;
+    if (state.editedSlots.size() < words) state.editedSlots.resize(words, 0);
+    for (const InstanceRange& range : dirtyRanges) {
+        for (uint32_t slot = range.first; slot < range.first + range.count; ++slot) setSlotBit(state.editedSlots, slot);
+    }
+    if (state.cell < 0) return false;
+    addEditedSlots(state);
+    return true;
+}
+
+void shutdownPvs(PvsState& state) {
+    stopPvsBuild(state.build);
+}
+
+// --- Benchmark ---
+void runPvsBenchmark() {
+    const int scales[] = { 1, 4 };
+    const int probes = 2000;
+    const int targetsPerProbe = 4;
+    for (int scale : scales) {
+        generateScaledWorld(1, scale);
+        WorldInstances instances;
+        buildWorldInstances(instances);
+        PvsInput input;
+        preparePvsInput(input, instances);
+        PvsGrid grid;
+        buildPvs(grid, input);
+        std::cout << "[pvsbench] " << scale << "x world: ";
+        printPvsReport(grid);
+
+        // From random walking eye positions, trace a dense grid of rays to objects left out of the
+        // cell's set, with trunks and balconies occluding too; any ray that gets through is an
+        // object the PVS wrongly hides
+        RayScene scene;
+        buildRayScene(scene);
+        WorldRandom random = makeWorldRandom(1, SEED_STREAM_QUERIES); // Same probes on every platform
+        std::vector<uint64_t> slotBits;
+        size_t hiddenTested = 0, wronglyHidden = 0;
+        for (int probe = 0; probe < probes; ++probe) {
+            glm::vec3 eye;
+            eye.x = grid.origin.x + worldRandomFloat(random) * grid.cellsX * PVS_CELL_SIZE;
+            eye.y = PVS_EYE_LOW + worldRandomFloat(random) * PVS_MAX_EYE_RISE;
+            eye.z = grid.origin.y + worldRandomFloat(random) * grid.cellsZ * PVS_CELL_SIZE;
+            Ray inside = { eye, glm::vec3(0.0f, 1.0f, 0.0f), 1e-3f };
+            if (castRay(scene, inside).objectId >= 0) continue;
+            decodePvsCell(grid, findPvsCell(grid, eye), slotBits);
+            for (int attempt = 0, tested = 0; attempt < 64 && tested < targetsPerProbe; ++attempt) {
+                const PvsTarget& target = grid.targets[worldRandomIndex(random, static_cast<uint32_t>(grid.targets.size()))];
+                uint32_t slot = grid.targetSlots[target.firstSlot];
+                if ((slotBits[slot / 64] >> (slot % 64)) & 1) continue;
+
+                tested++;
+                hiddenTested++;
+                bool seen = false;
+                for (int i = 0; i < 125 && !seen; ++i) {
+                    glm::vec3 t(i % 5 / 4.0f, i / 5 % 5 / 4.0f, i / 25 / 4.0f);
+                    Ray ray = { eye, target.boundsMin + (target.boundsMax - target.boundsMin) * t - eye, 1.0f };
+                    RayHit hit = castRay(scene, ray);
+                    seen = hit.objectId < 0 || containsPoint(target.boundsMin, target.boundsMax, eye + ray.direction * hit.distance);
+                }
+                if (seen) wronglyHidden++;
+            }
+        }
+        std::cout << "[pvsbench] " << scale << "x world: " << wronglyHidden << " of " << hiddenTested
+                  << " objects left out of a cell's set were visible from a random eye position in it" << std::endl;
+    }
+}
@@ -0,0 +1,126 @@
+// Potentially visible sets: the ground is divided into cells, and for each cell the objects
+// that can be seen from walking eye height (up to the top of a jump) are precomputed by ray
+// sampling against the large occluders. Each cell's set is stored as a compressed bitset; at
+// runtime the player's cell is found in O(1) and its set is decoded into draw slots once, when
+// the player enters it. Adding or removing an occluder drops the sets and rebuilds them on a
+// background thread, with normal culling in the meantime (and always in fly mode); other edits
+// only force their slots visible until the next rebuild.
+#pragma once
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "raycast.h"
+#include "world.h"
+#include "world_instances.h"
+
+// --- PVS Configuration ---
+const float PVS_CELL_SIZE = 16.0f;          // Edge of a ground cell
+const float PVS_MARGIN = 0.5f;              // Eye samples reach this far past the cell, and occluders are shrunk by this much
+const int PVS_EYE_SAMPLES_PER_SIDE = 3;     // Eye positions per cell edge, at each sampled height
+const float PVS_MAX_EYE_RISE = JUMP_FORCE * JUMP_FORCE / (2.0f * GRAVITY); // Top of a jump above eye height
+const double PVS_REBUILD_DELAY_SECONDS = 1.0; // The world must stay unchanged this long before a rebuild starts
+// Only houses and towers occlude: a trunk or balcony hides little from a whole cell, and leaving
+// occluders out only makes the sets larger, never wrong
+const unsigned int PVS_OCCLUDER_TYPES = (1u << RAY_OBJECT_HOUSE) | (1u << RAY_OBJECT_TOWER);
+
+// One object: its bounds and its draw slots (targetSlots[firstSlot, firstSlot + slotCount))
+struct PvsTarget {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    uint32_t firstSlot;
+    uint32_t slotCount;
+};
+
+// Snapshot of the world taken on the main thread, so the build can run beside edits
+struct PvsInput {
+    std::vector<RayPrimitive> occluders;      // PVS_OCCLUDER_TYPES boxes
+    std::vector<PvsTarget> targets;           // In Morton order of their position, so hidden ones form runs
+    std::vector<uint32_t> targetSlots;
+    std::vector<uint32_t> alwaysVisibleSlots; // Ground and sun
+    uint32_t slotCount = 0;
+    size_t liveSlots = 0;
+};
+
+struct PvsBuildStats {
+    double buildMs = 0.0;
+    size_t rays = 0;             // Eye-to-target segments tested against an occluder
+    unsigned int threads = 0;
+    size_t compressedBytes = 0;  // Encoded sets plus cell offsets
+    size_t rawBytes = 0;         // The same sets as plain bitsets
+    size_t liveSlots = 0;
+    double averageVisibleSlots = 0.0;
+    size_t maxVisibleSlots = 0;
+};
+
+// Each cell's set has one bit per target. It is stored as marker words, each followed by its
+// literal words: bit 63 is the fill bit, bits 32-62 the number of fill words and bits 0-31 the
+// number of literals.
+struct PvsGrid {
+    bool valid = false;
+    glm::vec2 origin = glm::vec2(0.0f); // XZ of the corner of cell 0
+    int cellsX = 0;
+    int cellsZ = 0;
+    std::vector<uint32_t> cellOffsets;  // cellsX * cellsZ + 1, into words
+    std::vector<uint64_t> words;
+    // To turn target bits into draw slots
+    uint32_t slotCount = 0;
+    std::vector<PvsTarget> targets;
+    std::vector<uint32_t> targetSlots;
+    std::vector<uint32_t> alwaysVisibleSlots;
+    PvsBuildStats stats;
+};
+
+void preparePvsInput(PvsInput& input, const WorldInstances& instances);
+// Computes every cell's set. threadCount 0 = all hardware threads. Returns false (leaving the
+// grid invalid) if `cancel` was raised.
+bool buildPvs(PvsGrid& grid, const PvsInput& input, unsigned int threadCount = 0, const std::atomic<bool>* cancel = NULL);
+// Cell under a walking eye position, or -1 outside the grid or above the heights it was built for
+int findPvsCell(const PvsGrid& grid, glm::vec3 eye);
+// Writes the cell's set as one bit per draw slot. Keeps the vector's capacity, so it does not
+// allocate after the first call.
+void decodePvsCell(const PvsGrid& grid, int cell, std::vector<uint64_t>& slotBits);
+void printPvsReport(const PvsGrid& grid);
+
+// --- Background Build and Runtime State ---
+struct PvsBackgroundBuild {
+    std::thread thread;
+    std::atomic<bool> done{ false };
+    std::atomic<bool> cancel{ false };
+    bool running = false;
+    PvsInput input;
+    PvsGrid result;
+};
+
+struct PvsState {
+    PvsGrid grid;                   // Invalid while building or after the world changed
+    PvsBackgroundBuild build;
+    std::vector<uint64_t> visible;  // Decoded slot bits of `cell`, plus editedSlots
+    int cell = -1;                  // -1: the PVS is not in use this frame, cull normally
+    double worldChangedTime = 0.0;
+    std::vector<uint64_t> occluderSlots; // Slots holding an occluder when the last build started
+    std::vector<uint64_t> editedSlots;   // Slots rewritten since then, drawn from every cell
+};
+
+// An occluder changed: drops the sets (and any build in progress) until a rebuild finishes
+void invalidatePvs(PvsState& state, double now);
+// This frame's dirty slots. Invalidates if any held or now holds an occluder; otherwise the sets
+// don't know what the slots hold now, so they are drawn from every cell until the next rebuild.
+// Returns true when `visible` changed.
+bool updatePvsEdits(PvsState& state, const WorldInstances& instances, const std::vector<InstanceRange>& dirtyRanges, double now);
+// Starts a background build once the world has settled, installs finished builds and picks the
+// eye's cell (none when flying). Returns true when `cell` changed.
+bool updatePvs(PvsState& state, const WorldInstances& instances, glm::vec3 eye, bool flying, double now);
+inline bool isPvsSlotVisible(const PvsState& state, size_t slot) {
+    return slot >= state.visible.size() * 64 || ((state.visible[slot / 64] >> (slot % 64)) & 1) != 0;
+}
+// Waits for a build in progress to stop
+void shutdownPvs(PvsState& state);
+
+// Builds the sets for 1x and 4x worlds and prints the report, then checks from random eye
+// positions, against every occluder type, how many objects left out of a cell's set can be seen.
+void runPvsBenchmark();
@@ -0,0 +1,396 @@
+#include "raycast.h"
+#include "world.h"
+#include "world_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+// --- Scene Build ---
+
+static void addPrimitive(RayScene& scene, glm::vec3 boundsMin, glm::vec3 boundsMax, RayPrimitiveShape shape, RayObjectType type, int index) {
+    scene.primitives.push_back({ boundsMin, boundsMax, shape, type, index });
+}
+
+// Recursive median split along the longest centroid axis
+static void buildBvhNode(RayScene& scene, int nodeIndex, int first, int count) {
+    glm::vec3 boundsMin(INFINITY), boundsMax(-INFINITY);
+    glm::vec3 centroidMin(INFINITY), centroidMax(-INFINITY);
+    for (int i = first; i < first + count; ++i) {
+        const RayPrimitive& prim = scene.primitives[i];
+        boundsMin = glm::min(boundsMin, prim.boundsMin);
+        boundsMax = glm::max(boundsMax, prim.boundsMax);
+        glm::vec3 centroid = (prim.boundsMin + prim.boundsMax) * 0.5f;
+        centroidMin = glm::min(centroidMin, centroid);
+        centroidMax = glm::max(centroidMax, centroid);
+    }
+    scene.nodes[nodeIndex].boundsMin = boundsMin;
+    scene.nodes[nodeIndex].boundsMax = boundsMax;
+
+    glm::vec3 centroidExtent = centroidMax - centroidMin;
+    int axis = 0;
+    if (centroidExtent.y > centroidExtent[axis]) axis = 1;
+    if (centroidExtent.z > centroidExtent[axis]) axis = 2;
+    if (count <= RAY_BVH_MAX_LEAF_SIZE || centroidExtent[axis] <= 0.0f) {
+        scene.nodes[nodeIndex].leftOrFirst = first;
+        scene.nodes[nodeIndex].primitiveCount = count;
+        return;
+    }
+
+    int half = count / 2;
+    auto begin = scene.primitives.begin() + first;
+    std::nth_element(begin, begin + half, begin + count, [axis](const RayPrimitive& a, const RayPrimitive& b) {
+        return a.boundsMin[axis] + a.boundsMax[axis] < b.boundsMin[axis] + b.boundsMax[axis];
+    });
+
+    // Children are allocated as a pair; take indices before push_back can reallocate
+    int left = static_cast<int>(scene.nodes.size());
+    scene.nodes.push_back(RayBvhNode());
+    scene.nodes.push_back(RayBvhNode());
+    scene.nodes[nodeIndex].leftOrFirst = left;
+    scene.nodes[nodeIndex].primitiveCount = 0;
+    buildBvhNode(scene, left, first, half);
+    buildBvhNode(scene, left + 1, first + half, count - half);
+}
+
+void buildRayScene(RayScene& scene, unsigned int objectTypes) {
+    scene.primitives.clear();
+    scene.nodes.clear();
+    scene.primitives.reserve(treePositions.size() + housePositions.size() + apartmentTowerPositions.size() + balconyData.size() * 4);
+
+    // Trunk cylinders span the drawn trunk height
+    for (size_t i = 0; (objectTypes & (1u << RAY_OBJECT_TREE)) && i < treePositions.size(); ++i) {
+        const glm::vec3& pos = treePositions[i];
+        glm::vec3 halfXZ(TREE_TRUNK_RADIUS, 0.0f, TREE_TRUNK_RADIUS);
+        addPrimitive(scene, pos - halfXZ, pos + halfXZ + glm::vec3(0.0f, TREE_TRUNK_HEIGHT, 0.0f), RAY_SHAPE_CYLINDER, RAY_OBJECT_TREE, static_cast<int>(i));
+    }
+    for (size_t i = 0; (objectTypes & (1u << RAY_OBJECT_HOUSE)) && i < housePositions.size(); ++i) {
+        const glm::vec3& pos = housePositions[i];
+        glm::vec3 halfXZ(HOUSE_BODY_WIDTH / 2.0f, 0.0f, HOUSE_BODY_DEPTH / 2.0f);
+        addPrimitive(scene, pos - halfXZ, pos + halfXZ + glm::vec3(0.0f, HOUSE_BODY_HEIGHT, 0.0f), RAY_SHAPE_BOX, RAY_OBJECT_HOUSE, static_cast<int>(i));
+    }
+    for (size_t i = 0; (objectTypes & (1u << RAY_OBJECT_TOWER)) && i < apartmentTowerPositions.size(); ++i) {
+        const glm::vec3& pos = apartmentTowerPositions[i];
+        glm::vec3 halfXZ(TOWER_WIDTH / 2.0f, 0.0f, TOWER_DEPTH / 2.0f);
+        addPrimitive(scene, pos - halfXZ, pos + halfXZ + glm::vec3(0.0f, TOWER_HEIGHT, 0.0f), RAY_SHAPE_BOX, RAY_OBJECT_TOWER, static_cast<int>(i));
+    }
+    // Balcony floor plus its three railings, each an exact box
+    for (size_t i = 0; (objectTypes & (1u << RAY_OBJECT_BALCONY)) && i < balconyData.size(); ++i) {
+        const Balcony& bal = balconyData[i];
+        int index = static_cast<int>(i);
+        addPrimitive(scene, bal.position - bal.dimensions * 0.5f, bal.position + bal.dimensions * 0.5f, RAY_SHAPE_BOX, RAY_OBJECT_BALCONY, index);
+        glm::vec3 front = bal.position + bal.railingFrontPosRel;
+        glm::vec3 left = bal.position + bal.railingLeftPosRel;
+        glm::vec3 right = bal.position + bal.railingRightPosRel;
+        addPrimitive(scene, front - bal.railingDimsFront * 0.5f, front + bal.railingDimsFront * 0.5f, RAY_SHAPE_BOX, RAY_OBJECT_BALCONY, index);
+        addPrimitive(scene, left - bal.railingDimsSide * 0.5f, left + bal.railingDimsSide * 0.5f, RAY_SHAPE_BOX, RAY_OBJECT_BALCONY, index);
+        addPrimitive(scene, right - bal.railingDimsSide * 0.5f, right + bal.railingDimsSide * 0.5f, RAY_SHAPE_BOX, RAY_OBJECT_BALCONY, index);
+    }
+
+    if (scene.primitives.empty()) return;
+    scene.nodes.reserve(scene.primitives.size() * 2);
+    scene.nodes.push_back(RayBvhNode());
+    buildBvhNode(scene, 0, 0, static_cast<int>(scene.primitives.size()));
+}
+
+// --- Primitive Intersection ---
+
+// Slab test. Origins inside the box report a hit at distance 0.
+static bool intersectBox(const RayPrimitive& prim, const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& invDir,
+                         float maxDistance, float& tHit, glm::vec3& normal) {
+    float tEnter = -INFINITY, tExit = INFINITY;
+    int enterAxis = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        float t1 = (prim.boundsMin[axis] - origin[axis]) * invDir[axis];
+        float t2 = (prim.boundsMax[axis] - origin[axis]) * invDir[axis];
+        float tNear = std::min(t1, t2), tFar = std::max(t1, t2);
+        if (tNear > tEnter) { tEnter = tNear; enterAxis = axis; }
+        tExit = std::min(tExit, tFar);
+    }
+    if (tExit < std::max(tEnter, 0.0f) || tEnter > maxDistance) return false;
+    if (tEnter < 0.0f) {
+        tHit = 0.0f;
+        normal = -direction;
+    }
+    else {
+        tHit = tEnter;
+        normal = glm::vec3(0.0f);
+        normal[enterAxis] = invDir[enterAxis] < 0.0f ? 1.0f : -1.0f;
+    }
+    return true;
+}
+
+// Vertical capped cylinder inscribed in the primitive's XZ footprint
+static bool intersectCylinder(const RayPrimitive& prim, const glm::vec3& origin, const glm::vec3& direction,
+                              float maxDistance, float& tHit, glm::vec3& normal) {
+    float radius = (prim.boundsMax.x - prim.boundsMin.x) * 0.5f;
+    float centerX = (prim.boundsMin.x + prim.boundsMax.x) * 0.5f;
+    float centerZ = (prim.boundsMin.z + prim.boundsMax.z) * 0.5f;
+    float ox = origin.x - centerX, oz = origin.z - centerZ;
+    float radiusSq = radius * radius;
+    bool insideXZ = ox * ox + oz * oz <= radiusSq;
+    if (insideXZ && origin.y >= prim.boundsMin.y && origin.y <= prim.boundsMax.y) {
+        tHit = 0.0f;
+        normal = -direction;
+        return true;
+    }
+
+    float best = maxDistance;
+    bool hit = false;
+    // Side wall
+    float a = direction.x * direction.x + direction.z * direction.z;
+    if (a > 0.0f && !insideXZ) {
+        float b = ox * direction.x + oz * direction.z;
+        float c = ox * ox + oz * oz - radiusSq;
+        float disc = b * b - a * c;
+        if (disc >= 0.0f) {
+            float t = (-b - std::sqrt(disc)) / a;
+            float y = origin.y + t * direction.y;
+            if (t >= 0.0f && t <= best && y >= prim.boundsMin.y && y <= prim.boundsMax.y) {
+                best = t; hit = true;
+                normal = glm::vec3((ox + t * direction.x) / radius, 0.0f, (oz + t * direction.z) / radius);
+            }
+        }
+    }
+    // Cap facing the origin
+    if (direction.y != 0.0f) {
+        bool fromAbove = origin.y > prim.boundsMax.y;
+        float capY = fromAbove ? prim.boundsMax.y : prim.boundsMin.y;
+        float t = (capY - origin.y) / direction.y;
+        if (t >= 0.0f && t <= best) {
+            float px = ox + t * direction.x, pz = oz + t * direction.z;
+            if (px * px + pz * pz <= radiusSq) {
+                best = t; hit = true;
+                normal = glm::vec3(0.0f, fromAbove ? 1.0f : -1.0f, 0.0f);
+            }
+        }
+    }
+    if (hit) tHit = best;
+    return hit;
+}
+
+static RayHit missHit(const Ray& ray) {
+    return { ray.maxDistance, glm::vec3(0.0f), -1, RAY_OBJECT_NONE, -1 };
+}
+
+// --- Packet Traversal ---
+
+// Traverse the BVH with up to RAY_PACKET_SIZE rays at once. A node is entered when any
+// active ray overlaps it closer than its current best hit; the SoA slab loop vectorizes.
+static void tracePacket(const RayScene& scene, const Ray* rays, RayHit* hits, int count) {
+    float ox[RAY_PACKET_SIZE], oy[RAY_PACKET_SIZE], oz[RAY_PACKET_SIZE];
+    float ix[RAY_PACKET_SIZE], iy[RAY_PACKET_SIZE], iz[RAY_PACKET_SIZE];
+    float tBest[RAY_PACKET_SIZE];
+    uint32_t validMask = 0;
+    for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+        const Ray& ray = rays[i < count ? i : 0];
+        ox[i] = ray.origin.x; oy[i] = ray.origin.y; oz[i] = ray.origin.z;
+        ix[i] = 1.0f / ray.direction.x; iy[i] = 1.0f / ray.direction.y; iz[i] = 1.0f / ray.direction.z;
+        tBest[i] = ray.maxDistance;
+        if (i < count) {
+            hits[i] = missHit(ray);
+            validMask |= 1u << i;
+        }
+    }
+    if (scene.nodes.empty()) return;
+
+    int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    const glm::vec3 leadDirection = rays[0].direction;
+    while (stackSize > 0) {
+        const RayBvhNode& node = scene.nodes[stack[--stackSize]];
+
+        bool overlaps[RAY_PACKET_SIZE];
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) {
+            float tx1 = (node.boundsMin.x - ox[i]) * ix[i], tx2 = (node.boundsMax.x - ox[i]) * ix[i];
+            float ty1 = (node.boundsMin.y - oy[i]) * iy[i], ty2 = (node.boundsMax.y - oy[i]) * iy[i];
+            float tz1 = (node.boundsMin.z - oz[i]) * iz[i], tz2 = (node.boundsMax.z - oz[i]) * iz[i];
+            float tNear = std::max(std::max(std::min(tx1, tx2), std::min(ty1, ty2)), std::min(tz1, tz2));
+            float tFar = std::min(std::min(std::max(tx1, tx2), std::max(ty1, ty2)), std::max(tz1, tz2));
+            overlaps[i] = tFar >= std::max(tNear, 0.0f) && tNear <= tBest[i];
+        }
+        uint32_t activeMask = 0;
+        for (int i = 0; i < RAY_PACKET_SIZE; ++i) activeMask |= overlaps[i] ? (1u << i) : 0u;
+        activeMask &= validMask;
+        if (activeMask == 0) continue;
+
+        if (node.primitiveCount == 0) {
+            // Push the far child first so the near one is popped next
+            const RayBvhNode& left = scene.nodes[node.leftOrFirst];
+            const RayBvhNode& right = scene.nodes[node.leftOrFirst + 1];
+            glm::vec3 toLeft = (left.boundsMin + left.boundsMax) - (right.boundsMin + right.boundsMax);
+            bool leftIsFar = glm::dot(toLeft, leadDirection) > 0.0f;
+            stack[stackSize++] = leftIsFar ? node.leftOrFirst : node.leftOrFirst + 1;
+            stack[stackSize++] = leftIsFar ? node.leftOrFirst + 1 : node.leftOrFirst;
+            continue;
+        }
+
+        for (int p = node.leftOrFirst; p < node.leftOrFirst + node.primitiveCount; ++p) {
+            const RayPrimitive& prim = scene.primitives[p];
+            for (uint32_t mask = activeMask; mask != 0; mask &= mask - 1) {
+                int i = 0;
+                while (!(mask & (1u << i))) ++i;
+                const Ray& ray = rays[i];
+                float t; glm::vec3 normal;
+                bool hit = prim.shape == RAY_SHAPE_CYLINDER
+                    ? intersectCylinder(prim, ray.origin, ray.direction, tBest[i], t, normal)
+                    : intersectBox(prim, ray.origin, ray.direction, glm::vec3(ix[i], iy[i], iz[i]), tBest[i], t, normal);
+                if (hit && t <= tBest[i]) {
+                    tBest[i] = t;
+                    hits[i] = { t, normal, p, prim.objectType, prim.objectIndex };
+                }
+            }
+        }
+    }
+}
+
+// Packets only pay off when their rays share a direction and start close together;
+// otherwise every ray drags the others through its nodes and single rays are faster.
+static bool isCoherentPacket(const Ray* rays, int count) {
+    glm::vec3 leadDirection = glm::normalize(rays[0].direction);
+    for (int i = 1; i < count; ++i) {
+        if (glm::dot(glm::normalize(rays[i].direction), leadDirection) < RAY_PACKET_MIN_DIRECTION_COS) return false;
+        glm::vec3 offset = rays[i].origin - rays[0].origin;
+        if (glm::dot(offset, offset) > RAY_PACKET_MAX_ORIGIN_SPREAD * RAY_PACKET_MAX_ORIGIN_SPREAD) return false;
+    }
+    return true;
+}
+
+static void tracePacketRange(const RayScene& scene, const Ray* rays, RayHit* hits, size_t count, size_t firstPacket, size_t lastPacket) {
+    for (size_t packet = firstPacket; packet < lastPacket; ++packet) {
+        size_t first = packet * RAY_PACKET_SIZE;
+        int packetRays = static_cast<int>(std::min<size_t>(RAY_PACKET_SIZE, count - first));
+        if (isCoherentPacket(rays + first, packetRays)) {
+            tracePacket(scene, rays + first, hits + first, packetRays);
+        }
+        else {
+            for (int i = 0; i < packetRays; ++i) tracePacket(scene, rays + first + i, hits + first + i, 1);
+        }
+    }
+}
+
+void castRays(const RayScene& scene, const Ray* rays, RayHit* hits, size_t count, unsigned int threadCount) {
+    if (count == 0) return;
+    size_t packetCount = (count + RAY_PACKET_SIZE - 1) / RAY_PACKET_SIZE;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned int>(std::min<size_t>(threadCount, std::max<size_t>(1, count / RAY_MIN_RAYS_PER_THREAD)));
+    if (threadCount <= 1) {
+        tracePacketRange(scene, rays, hits, count, 0, packetCount);
+        return;
+    }
+
+    // Workers pull small blocks of packets so uneven ray costs still balance
+    const size_t packetsPerBlock = 32;
+    std::atomic<size_t> nextPacket(0);
+    auto worker = [&]() {
+        for (;;) {
+            size_t first = nextPacket.fetch_add(packetsPerBlock);
+            if (first >= packetCount) break;
+            tracePacketRange(scene, rays, hits, count, first, std::min(first + packetsPerBlock, packetCount));
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned int t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
+
+RayHit castRay(const RayScene& scene, const Ray& ray) {
+    RayHit hit;
+    tracePacket(scene, &ray, &hit, 1);
+    return hit;
+}
+
+// --- Benchmark ---
+
+// Reference answer: every primitive against every ray
+static RayHit castRayBruteForce(const RayScene& scene, const Ray& ray) {
+    RayHit best = missHit(ray);
+    glm::vec3 invDir = 1.0f / ray.direction;
+    for (size_t p = 0; p < scene.primitives.size(); ++p) {
+        const RayPrimitive& prim = scene.primitives[p];
+        float t; glm::vec3 normal;
+        bool hit = prim.shape == RAY_SHAPE_CYLINDER
+            ? intersectCylinder(prim, ray.origin, ray.direction, best.distance, t, normal)
+            : intersectBox(prim, ray.origin, ray.direction, invDir, best.distance, t, normal);
+        if (hit && t <= best.distance) best = { t, normal, static_cast<int>(p), prim.objectType, prim.objectIndex };
+    }
+    return best;
+}
+
+static void benchmarkRaySet(const RayScene& scene, const char* name, const std::vector<Ray>& rays) {
+    std::vector<RayHit> hits(rays.size());
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    auto timeCast = [&](unsigned int threads) {
+        auto start = std::chrono::steady_clock::now();
+        castRays(scene, rays.data(), hits.data(), rays.size(), threads);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    double singleSeconds = timeCast(1);
+    double parallelSeconds = timeCast(threadCount);
+
+    size_t hitCount = 0;
+    for (const auto& hit : hits) hitCount += hit.objectId >= 0 ? 1 : 0;
+    // Distances are compared rather than IDs: coincident faces may legitimately resolve either way
+    size_t checked = std::min<size_t>(rays.size(), 4096), mismatches = 0;
+    for (size_t i = 0; i < checked; ++i) {
+        RayHit reference = castRayBruteForce(scene, rays[i]);
+        if ((reference.objectId >= 0) != (hits[i].objectId >= 0) || std::abs(reference.distance - hits[i].distance) > 1e-3f) mismatches++;
+    }
+
+    std::cout << "[raybench] " << name << ": " << rays.size() << " rays, "
+              << (rays.size() / singleSeconds) / 1e6 << " Mrays/s (1 thread), "
+              << (rays.size() / parallelSeconds) / 1e6 << " Mrays/s (" << threadCount << " threads), "
+              << hitCount << " hits, " << mismatches << "/" << checked << " mismatches vs brute force" << std::endl;
+}
+
+void runRayCastBenchmark(size_t rayCount) {
+    RayScene scene;
+    auto buildStart = std::chrono::steady_clock::now();
+    buildRayScene(scene);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    std::cout << "[raybench] BVH: " << scene.primitives.size() << " primitives, " << scene.nodes.size() << " nodes, built in " << buildMs << " ms" << std::endl;
+
+    WorldRandom random = makeWorldRandom(1, SEED_STREAM_QUERIES); // Same rays on every platform
+    const float eyeY = GROUND_LEVEL + PLAYER_EYE_HEIGHT;
+    int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(rayCount))));
+    std::vector<Ray> rays;
+    rays.reserve(static_cast<size_t>(side) * side);
+
+    // Picking / camera rays: a screen-space grid through a 90x60 degree frustum from the spawn point
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            float u = (x + 0.5f) / side * 2.0f - 1.0f;
+            float v = (y + 0.5f) / side * 2.0f - 1.0f;
+            glm::vec3 dir = glm::normalize(glm::vec3(u, v * 0.577f, -1.0f));
+            rays.push_back({ glm::vec3(0.0f, eyeY, 3.0f), dir, GROUND_SIZE * 2.0f });
+        }
+    }
+    benchmarkRaySet(scene, "picking (camera grid)", rays);
+
+    // Agent line of sight: random eye-height segments; direction spans the segment so maxDistance is 1
+    rays.clear();
+    for (int i = 0; i < side * side; ++i) {
+        glm::vec3 from = randomAreaPoint(random, GROUND_SIZE, eyeY);
+        glm::vec3 to = randomAreaPoint(random, GROUND_SIZE, eyeY);
+        rays.push_back({ from, to - from, 1.0f });
+    }
+    benchmarkRaySet(scene, "line of sight (random agents)", rays);
+
+    // Sun probes: a ground grid in row order, each probing towards the sun
+    rays.clear();
+    for (int z = 0; z < side; ++z) {
+        for (int x = 0; x < side; ++x) {
+            glm::vec3 from(((x + 0.5f) / side - 0.5f) * GROUND_SIZE, GROUND_LEVEL + 0.1f, ((z + 0.5f) / side - 0.5f) * GROUND_SIZE);
+            rays.push_back({ from, SUN_POSITION - from, 1.0f });
+        }
+    }
+    benchmarkRaySet(scene, "sun visibility (ground grid)", rays);
+}
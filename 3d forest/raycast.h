@@ -0,0 +1,76 @@
+// Batched ray queries against the static world: the same trunk cylinders, house/tower
+// boxes and balcony floors/railings that checkCollision() knows about, organised in a BVH.
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+
+// --- Ray Query Configuration ---
+const int RAY_PACKET_SIZE = 8;          // Rays traversed together through the BVH
+const int RAY_BVH_MAX_LEAF_SIZE = 4;    // Primitives per BVH leaf
+const float RAY_PACKET_MIN_DIRECTION_COS = 0.95f; // Less aligned packets are traced ray by ray
+const float RAY_PACKET_MAX_ORIGIN_SPREAD = 10.0f;  // Likewise for origins further apart than this
+const size_t RAY_MIN_RAYS_PER_THREAD = 2048; // Smaller batches stay on the calling thread
+
+enum RayObjectType {
+    RAY_OBJECT_NONE = 0,
+    RAY_OBJECT_TREE,
+    RAY_OBJECT_HOUSE,
+    RAY_OBJECT_TOWER,
+    RAY_OBJECT_BALCONY // Floor and railings all report the balcony they belong to
+};
+const unsigned int RAY_OBJECTS_ALL = ~0u; // Mask of (1 << RayObjectType) bits
+
+enum RayPrimitiveShape {
+    RAY_SHAPE_BOX = 0,
+    RAY_SHAPE_CYLINDER // Vertical cylinder inscribed in the XZ footprint of the bounds
+};
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;  // Need not be normalized; distances are in units of |direction|
+    float maxDistance;
+};
+
+struct RayHit {
+    float distance;        // Ray parameter of the hit; 0 when the origin starts inside a primitive
+    glm::vec3 normal;      // Outward surface normal (-direction when starting inside)
+    int objectId;          // Index into RayScene::primitives, -1 on miss
+    RayObjectType objectType;
+    int objectIndex;       // Index into treePositions/housePositions/apartmentTowerPositions/balconyData
+};
+
+struct RayPrimitive {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    RayPrimitiveShape shape;
+    RayObjectType objectType;
+    int objectIndex;
+};
+
+// Interior nodes have primitiveCount == 0 and children at leftOrFirst, leftOrFirst + 1.
+struct RayBvhNode {
+    glm::vec3 boundsMin;
+    int leftOrFirst;
+    glm::vec3 boundsMax;
+    int primitiveCount;
+};
+
+struct RayScene {
+    std::vector<RayPrimitive> primitives; // Reordered by the BVH build
+    std::vector<RayBvhNode> nodes;
+};
+
+// Build primitives and BVH from the current world globals. Call again after regenerating.
+// `objectTypes` limits the scene to some object types, e.g. only the large occluders.
+void buildRayScene(RayScene& scene, unsigned int objectTypes = RAY_OBJECTS_ALL);
+
+// Trace `count` rays, writing one RayHit per ray. threadCount 0 = all hardware threads.
+// Rays are grouped into packets in input order, so submit coherent rays next to each other;
+// packets whose rays diverge are traced one ray at a time.
+void castRays(const RayScene& scene, const Ray* rays, RayHit* hits, size_t count, unsigned int threadCount = 0);
+RayHit castRay(const RayScene& scene, const Ray& ray);
+
+// Micro-benchmark over the generated world: picking, line-of-sight and sun-probe ray sets.
+void runRayCastBenchmark(size_t rayCount);
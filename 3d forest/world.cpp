@@ -0,0 +1,586 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#include "world.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/norm.hpp> // For glm::length2
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+
+// --- Object Positions (Global for Collision Checks) ---
+// Arenas first: they must outlive the arrays allocated from them
+static Arena treeArena(MEMORY_WORLD), bushArena(MEMORY_WORLD), houseArena(MEMORY_WORLD), towerArena(MEMORY_WORLD), balconyArena(MEMORY_WORLD);
+WorldPositions treePositions((ArenaAllocator<glm::vec3>(&treeArena)));
+WorldPositions bushPositions((ArenaAllocator<glm::vec3>(&bushArena)));
+WorldPositions housePositions((ArenaAllocator<glm::vec3>(&houseArena)));
+WorldPositions apartmentTowerPositions((ArenaAllocator<glm::vec3>(&towerArena))); // Vector for tower positions
+ArenaVector<Balcony> balconyData((ArenaAllocator<Balcony>(&balconyArena))); // Global vector to store all balconies
+
+// --- Global Settings (set by the seed dialog on Windows) ---
+unsigned int g_seed = 0;
+bool g_flyModeEnabled = false; // *** NEW: Global flag for fly mode ***
+
+// --- Collision Grid ---
+// Largest collider half-footprint (towers): an object can only touch a point whose cell lies
+// within this distance of the object's own cell.
+static const float COLLIDER_MAX_HALF_EXTENT = TOWER_WIDTH / 2.0f;
+
+struct ColliderRef {
+    uint32_t index; // Into the position array of `type`
+    uint8_t type;   // WorldObjectType
+};
+static Arena collisionCellArena(MEMORY_WORLD);                         // Backs every cell; reset on rebuild
+static std::vector<ArenaVector<ColliderRef>> collisionCells;           // collisionGridDim^2, row-major in Z
+static std::vector<uint32_t> colliderCellSlots[OBJECT_TYPE_COUNT];     // Per object: its entry within its cell
+static float collisionGridHalfSize = GROUND_SIZE / 2.0f; // Square around the origin, grown to fit generated worlds
+static int collisionGridDim = 0;
+static bool collisionGridValid = false; // Cleared by invalidateCollisionGrid()
+
+static int collisionCellCoord(float v) {
+    float cell = std::floor((v + collisionGridHalfSize) / COLLISION_CELL_SIZE);
+    return static_cast<int>(glm::clamp(cell, 0.0f, static_cast<float>(collisionGridDim - 1))); // Border cells take the overflow
+}
+
+static glm::vec3 objectAnchor(int type, size_t index) {
+    switch (type) {
+    case OBJECT_TREE: return treePositions[index];
+    case OBJECT_BUSH: return bushPositions[index];
+    case OBJECT_HOUSE: return housePositions[index];
+    case OBJECT_TOWER: return apartmentTowerPositions[index];
+    default: return balconyData[index].position;
+    }
+}
+
+static ArenaVector<ColliderRef>& collisionCellAt(glm::vec3 position) {
+    return collisionCells[collisionCellCoord(position.z) * collisionGridDim + collisionCellCoord(position.x)];
+}
+
+static void insertCollider(int type, size_t index) {
+    ArenaVector<ColliderRef>& cell = collisionCellAt(objectAnchor(type, index));
+    ColliderRef ref;
+    ref.index = static_cast<uint32_t>(index);
+    ref.type = static_cast<uint8_t>(type);
+    colliderCellSlots[type][index] = static_cast<uint32_t>(cell.size());
+    cell.push_back(ref);
+}
+
+// Swap-remove from the cell, fixing the slot of whichever entry filled the gap
+static void eraseCollider(int type, size_t index) {
+    ArenaVector<ColliderRef>& cell = collisionCellAt(objectAnchor(type, index));
+    uint32_t slot = colliderCellSlots[type][index];
+    cell[slot] = cell.back();
+    colliderCellSlots[cell[slot].type][cell[slot].index] = slot;
+    cell.pop_back();
+}
+
+void invalidateCollisionGrid() {
+    collisionGridValid = false;
+}
+
+static void ensureCollisionGrid() {
+    if (collisionGridValid) return;
+    collisionGridHalfSize = GROUND_SIZE / 2.0f;
+    for (int type = OBJECT_TREE; type < OBJECT_TYPE_COUNT; ++type) {
+        for (size_t i = 0, count = getWorldObjectCount(static_cast<WorldObjectType>(type)); i < count; ++i) {
+            glm::vec3 anchor = objectAnchor(type, i);
+            collisionGridHalfSize = glm::max(collisionGridHalfSize, glm::max(std::abs(anchor.x), std::abs(anchor.z)));
+        }
+    }
+    collisionGridDim = static_cast<int>(2.0f * collisionGridHalfSize / COLLISION_CELL_SIZE) + 1;
+    collisionCells.clear();
+    resetArena(collisionCellArena);
+    collisionCells.resize(static_cast<size_t>(collisionGridDim) * collisionGridDim, ArenaVector<ColliderRef>(ArenaAllocator<ColliderRef>(&collisionCellArena)));
+    for (int type = OBJECT_TREE; type < OBJECT_TYPE_COUNT; ++type) {
+        size_t count = getWorldObjectCount(static_cast<WorldObjectType>(type));
+        colliderCellSlots[type].assign(count, 0);
+        for (size_t i = 0; i < count; ++i) insertCollider(type, i);
+    }
+    collisionGridValid = true;
+}
+
+// --- Collision Tests ---
+static bool collidesWithTree(glm::vec2 playerPosXZ, const glm::vec3& treeBasePos) {
+    // Cylinder collision
+    glm::vec2 treePosXZ(treeBasePos.x, treeBasePos.z);
+    float distSq = glm::length2(playerPosXZ - treePosXZ);
+    float minCollisionDist = PLAYER_RADIUS + TREE_TRUNK_RADIUS;
+    return distSq < minCollisionDist * minCollisionDist;
+}
+
+// AABB collision in XZ, used for houses and apartment towers
+static bool collidesWithFootprint(glm::vec2 playerPosXZ, const glm::vec3& basePos, float width, float depth) {
+    float objMinX = basePos.x - width / 2.0f;
+    float objMaxX = basePos.x + width / 2.0f;
+    float objMinZ = basePos.z - depth / 2.0f;
+    float objMaxZ = basePos.z + depth / 2.0f;
+    float closestX = glm::clamp(playerPosXZ.x, objMinX, objMaxX);
+    float closestZ = glm::clamp(playerPosXZ.y, objMinZ, objMaxZ); // Use playerPosXZ.y for Z component
+    glm::vec2 closestPointXZ(closestX, closestZ);
+    float distSq = glm::length2(playerPosXZ - closestPointXZ);
+    return distSq < (PLAYER_RADIUS * PLAYER_RADIUS);
+}
+
+// AABB collision with vertical check
+static bool collidesWithBalcony(glm::vec3 nextPos, glm::vec2 playerPosXZ, const Balcony& bal) {
+    // Define the balcony AABB in the XZ plane (using its center and dimensions)
+    float balMinX = bal.position.x - bal.dimensions.x / 2.0f;
+    float balMaxX = bal.position.x + bal.dimensions.x / 2.0f;
+    float balMinZ = bal.position.z - bal.dimensions.z / 2.0f; // Using depth for Z
+    float balMaxZ = bal.position.z + bal.dimensions.z / 2.0f;
+
+    // Find the closest point on the balcony AABB to the player's center XZ position
+    float closestX = glm::clamp(playerPosXZ.x, balMinX, balMaxX);
+    float closestZ = glm::clamp(playerPosXZ.y, balMinZ, balMaxZ); // playerPosXZ.y is player's Z
+
+    // Calculate the distance squared between the player's XZ center and this closest point
+    glm::vec2 closestPointXZ(closestX, closestZ);
+    float distSq = glm::length2(playerPosXZ - closestPointXZ);
+
+    // If the horizontal distance squared is less than the player's radius squared,
+    // then check vertical alignment.
+    if (distSq < (PLAYER_RADIUS * PLAYER_RADIUS)) {
+        // Calculate player's vertical bounds (feet and head)
+        float playerFeetY = nextPos.y - PLAYER_EYE_HEIGHT;
+        float playerHeadY = nextPos.y;
+
+        // Calculate balcony's vertical bounds (floor bottom to railing top)
+        float balconyFloorBottomY = bal.position.y - bal.dimensions.y / 2.0f;
+        // Consider railing height for the top bound
+        float balconyEffectiveTopY = bal.position.y + bal.dimensions.y / 2.0f + BALCONY_RAILING_HEIGHT;
+
+        // Check for vertical overlap:
+        // Player is overlapping if their head is above the balcony floor AND their feet are below the balcony top (including railing)
+        return playerHeadY > balconyFloorBottomY && playerFeetY < balconyEffectiveTopY;
+    }
+    return false;
+}
+
+// Check collision between player at nextPos and world obstacles (trees, houses, towers, balconies)
+// in the grid cells around it.
+// NOTE: This function is now only called if g_flyModeEnabled is false.
+bool checkCollision(glm::vec3 nextPos) {
+    ensureCollisionGrid();
+    // Player's horizontal position (ignore Y for this check initially)
+    glm::vec2 playerPosXZ(nextPos.x, nextPos.z);
+
+    const float reach = PLAYER_RADIUS + COLLIDER_MAX_HALF_EXTENT;
+    int minX = collisionCellCoord(nextPos.x - reach), maxX = collisionCellCoord(nextPos.x + reach);
+    int minZ = collisionCellCoord(nextPos.z - reach), maxZ = collisionCellCoord(nextPos.z + reach);
+    for (int z = minZ; z <= maxZ; ++z) {
+        for (int x = minX; x <= maxX; ++x) {
+            for (const ColliderRef& ref : collisionCells[z * collisionGridDim + x]) {
+                bool hit = false;
+                switch (ref.type) {
+                case OBJECT_TREE: hit = collidesWithTree(playerPosXZ, treePositions[ref.index]); break;
+                case OBJECT_HOUSE: hit = collidesWithFootprint(playerPosXZ, housePositions[ref.index], HOUSE_BODY_WIDTH, HOUSE_BODY_DEPTH); break;
+                case OBJECT_TOWER: hit = collidesWithFootprint(playerPosXZ, apartmentTowerPositions[ref.index], TOWER_WIDTH, TOWER_DEPTH); break;
+                case OBJECT_BALCONY: hit = collidesWithBalcony(nextPos, playerPosXZ, balconyData[ref.index]); break;
+                default: break; // Bushes currently don't have collision
+                }
+                if (hit) return true; // Collision detected
+            }
+        }
+    }
+    return false; // No collision
+}
+
+
+// --- Seed Streams ---
+// SplitMix64: a full-period 64-bit generator whose output mixing also makes a good hash
+static uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static WorldRandom mixWorldRandom(uint64_t base, uint64_t value) {
+    WorldRandom random;
+    uint64_t state = base ^ (value * 0xD6E8FEB86659FD93ull);
+    random.state = splitMix64(state);
+    return random;
+}
+
+WorldRandom makeWorldRandom(unsigned int seed, WorldSeedStream stream, uint32_t variation) {
+    WorldRandom random = mixWorldRandom(seed, stream);
+    return mixWorldRandom(random.state, variation);
+}
+
+WorldRandom forkWorldRandom(const WorldRandom& parent, uint32_t index) {
+    return mixWorldRandom(parent.state, static_cast<uint64_t>(index) + 1);
+}
+
+float worldRandomFloat(WorldRandom& random) {
+    return static_cast<float>(splitMix64(random.state) >> 40) * (1.0f / 16777216.0f); // Top 24 bits, exact in a float
+}
+
+uint32_t worldRandomIndex(WorldRandom& random, uint32_t range) {
+    return static_cast<uint32_t>(((splitMix64(random.state) >> 32) * range) >> 32);
+}
+
+// Generate Object Positions (Generic version, used for trees, bushes, houses and towers)
+void generateObjectPositions(WorldPositions& positions, float areaSize, int count, WorldRandom& random) {
+    float halfSize = areaSize / 2.0f;
+    resetArenaVector(positions, count);
+    for (int i = 0; i < count; ++i) {
+        float x = worldRandomFloat(random) * areaSize - halfSize;
+        float z = worldRandomFloat(random) * areaSize - halfSize;
+        positions.push_back(glm::vec3(x, GROUND_LEVEL, z));
+    }
+}
+
+// Every category from its own stream of the seed, so the order of these calls doesn't matter
+void generateWorld(unsigned int seed) {
+    WorldRandom trees = makeWorldRandom(seed, SEED_STREAM_TREES);
+    WorldRandom bushes = makeWorldRandom(seed, SEED_STREAM_BUSHES);
+    WorldRandom houses = makeWorldRandom(seed, SEED_STREAM_HOUSES);
+    invalidateCollisionGrid();
+    generateObjectPositions(treePositions, GROUND_SIZE, TREE_COUNT, trees);
+    generateObjectPositions(bushPositions, GROUND_SIZE, BUSH_COUNT, bushes);
+    generateObjectPositions(housePositions, GROUND_SIZE, HOUSE_COUNT, houses);
+    generateTowersAndBalconies(GROUND_SIZE, APARTMENT_TOWER_COUNT, BALCONIES_PER_TOWER, seed);
+}
+
+void generateTowersAndBalconies(float areaSize, int towerCount, int balconiesPerTower, unsigned int seed) {
+    WorldRandom towers = makeWorldRandom(seed, SEED_STREAM_TOWERS);
+    invalidateCollisionGrid();
+    generateObjectPositions(apartmentTowerPositions, areaSize, towerCount, towers);
+    generateBalconies(balconiesPerTower, makeWorldRandom(seed, SEED_STREAM_BALCONIES));
+}
+
+// --- Generate Balconies ---
+void generateBalconies(int balconiesPerTower, const WorldRandom& random) {
+    invalidateCollisionGrid();
+    generateBalconies(balconyData, apartmentTowerPositions, balconiesPerTower, random);
+}
+
+void generateBalconies(ArenaVector<Balcony>& balconies, const WorldPositions& towers, int balconiesPerTower, const WorldRandom& random) {
+    resetArenaVector(balconies, towers.size() * balconiesPerTower); // Reserve space
+
+    for (size_t i = 0; i < towers.size(); ++i) {
+        glm::vec3 towerBasePos = towers[i];
+        float towerX = towerBasePos.x;
+        float towerZ = towerBasePos.z;
+        WorldRandom towerRandom = forkWorldRandom(random, static_cast<uint32_t>(i));
+
+        // --- Generate Balconies for this Tower ---
+        for (int j = 0; j < balconiesPerTower; ++j) {
+            Balcony bal;
+
+            // Determine balcony height (distribute somewhat evenly, avoiding very top/bottom)
+            float heightFraction = (static_cast<float>(j + 1) / (balconiesPerTower + 1));
+            float balconyY = towerBasePos.y + TOWER_HEIGHT * heightFraction; // Center Y of the balcony floor
+
+            // Determine which side the balcony is on (randomly)
+            int side = static_cast<int>(worldRandomIndex(towerRandom, 4)); // 0: +Z, 1: -Z, 2: +X, 3: -X
+            float balconyX = towerX;
+            float balconyZ = towerZ;
+            float railingOffsetX = BALCONY_WIDTH / 2.0f - BALCONY_RAILING_THICKNESS / 2.0f;
+            float railingOffsetZ = BALCONY_DEPTH / 2.0f - BALCONY_RAILING_THICKNESS / 2.0f;
+            float railingOffsetY = BALCONY_FLOOR_HEIGHT / 2.0f + BALCONY_RAILING_HEIGHT / 2.0f;
+
+            bal.dimensions = glm::vec3(BALCONY_WIDTH, BALCONY_FLOOR_HEIGHT, BALCONY_DEPTH);
+            bal.railingDimsFront = glm::vec3(BALCONY_WIDTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS);
+            bal.railingDimsSide = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_DEPTH);
+
+
+            if (side == 0) { // Front (+Z)
+                balconyZ += TOWER_DEPTH / 2.0f + BALCONY_DEPTH / 2.0f;
+                bal.railingFrontPosRel = glm::vec3(0.0f, railingOffsetY, railingOffsetZ);
+                bal.railingLeftPosRel = glm::vec3(-railingOffsetX, railingOffsetY, 0.0f);
+                bal.railingRightPosRel = glm::vec3(railingOffsetX, railingOffsetY, 0.0f);
+            }
+            else if (side == 1) { // Back (-Z)
+                balconyZ -= TOWER_DEPTH / 2.0f + BALCONY_DEPTH / 2.0f;
+                bal.railingFrontPosRel = glm::vec3(0.0f, railingOffsetY, -railingOffsetZ); // Back railing
+                bal.railingLeftPosRel = glm::vec3(-railingOffsetX, railingOffsetY, 0.0f);
+                bal.railingRightPosRel = glm::vec3(railingOffsetX, railingOffsetY, 0.0f);
+                // Swap side railing dims W/D
+                bal.railingDimsFront = glm::vec3(BALCONY_WIDTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS);
+                bal.railingDimsSide = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_DEPTH);
+            }
+            else if (side == 2) { // Right (+X)
+                balconyX += TOWER_WIDTH / 2.0f + BALCONY_DEPTH / 2.0f; // Use depth for offset along X
+                bal.dimensions = glm::vec3(BALCONY_DEPTH, BALCONY_FLOOR_HEIGHT, BALCONY_WIDTH); // Swap W/D for dimensions
+                bal.railingFrontPosRel = glm::vec3(railingOffsetZ, railingOffsetY, 0.0f); // Use Z offset for X direction railing
+                bal.railingLeftPosRel = glm::vec3(0.0f, railingOffsetY, -railingOffsetX); // Use X offset for Z direction railing
+                bal.railingRightPosRel = glm::vec3(0.0f, railingOffsetY, railingOffsetX); // Use X offset for Z direction railing
+                // Swap railing dims
+                bal.railingDimsFront = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_WIDTH); // Thickness, Height, Width(as depth)
+                bal.railingDimsSide = glm::vec3(BALCONY_DEPTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS); // Depth(as width), Height, Thickness
+
+            }
+            else { // Left (-X)
+                balconyX -= TOWER_WIDTH / 2.0f + BALCONY_DEPTH / 2.0f; // Use depth for offset along X
+                bal.dimensions = glm::vec3(BALCONY_DEPTH, BALCONY_FLOOR_HEIGHT, BALCONY_WIDTH); // Swap W/D for dimensions
+                bal.railingFrontPosRel = glm::vec3(-railingOffsetZ, railingOffsetY, 0.0f); // Use Z offset for X direction railing
+                bal.railingLeftPosRel = glm::vec3(0.0f, railingOffsetY, -railingOffsetX); // Use X offset for Z direction railing
+                bal.railingRightPosRel = glm::vec3(0.0f, railingOffsetY, railingOffsetX); // Use X offset for Z direction railing
+                // Swap railing dims
+                bal.railingDimsFront = glm::vec3(BALCONY_RAILING_THICKNESS, BALCONY_RAILING_HEIGHT, BALCONY_WIDTH); // Thickness, Height, Width(as depth)
+                bal.railingDimsSide = glm::vec3(BALCONY_DEPTH, BALCONY_RAILING_HEIGHT, BALCONY_RAILING_THICKNESS); // Depth(as width), Height, Thickness
+            }
+
+
+            bal.position = glm::vec3(balconyX, balconyY, balconyZ);
+            balconies.push_back(bal);
+            // std::cout << "Generated Balcony at: " << glm::to_string(bal.position) << std::endl; // Debug
+        }
+    }
+}
+
+
+
+// --- World Parts ---
+const glm::vec3 WORLD_PART_COLORS[PART_COUNT] = {
+    glm::vec3(0.2f, 0.8f, 0.2f),   // Ground
+    SUN_COLOR,                     // Sun
+    glm::vec3(0.6f, 0.4f, 0.2f),   // Tree trunk
+    glm::vec3(0.1f, 0.5f, 0.1f),   // Tree leaves
+    glm::vec3(0.2f, 0.6f, 0.1f),   // Bush
+    glm::vec3(0.8f, 0.7f, 0.5f),   // House body
+    glm::vec3(0.4f, 0.2f, 0.1f),   // House roof
+    glm::vec3(0.3f, 0.15f, 0.05f), // House door
+    glm::vec3(0.6f, 0.8f, 0.9f),   // House window
+    glm::vec3(0.6f, 0.6f, 0.65f),  // Tower (grey)
+    glm::vec3(0.7f, 0.7f, 0.75f),  // Balcony floor (slightly lighter grey)
+    glm::vec3(0.4f, 0.4f, 0.4f)    // Balcony railing (darker grey)
+};
+const char* const WORLD_PART_NAMES[PART_COUNT] = {
+    "ground", "sun", "tree_trunk", "tree_leaves", "bush", "house_body", "house_roof",
+    "house_door", "house_window", "tower", "balcony_floor", "balcony_railing"
+};
+
+// Object shapes not needed for collision
+const float BUSH_SCALE = 0.8f;
+const float HOUSE_ROOF_HEIGHT = 0.3f;
+const float HOUSE_ROOF_OVERHANG = 0.4f;
+const float HOUSE_DOOR_WIDTH = 1.0f;
+const float HOUSE_DOOR_HEIGHT = 2.0f;
+const float HOUSE_WINDOW_SIZE = 0.8f;
+
+// Parts are enumerated object type by object type
+const size_t WORLD_OBJECT_PART_COUNTS[OBJECT_TYPE_COUNT] = { 1, 1, 2, 1, 5, 1, 4 };
+
+size_t getWorldObjectCount(WorldObjectType type) {
+    switch (type) {
+    case OBJECT_TREE: return treePositions.size();
+    case OBJECT_BUSH: return bushPositions.size();
+    case OBJECT_HOUSE: return housePositions.size();
+    case OBJECT_TOWER: return apartmentTowerPositions.size();
+    case OBJECT_BALCONY: return balconyData.size();
+    default: return 1; // Ground, sun
+    }
+}
+
+static WorldPart makePart(glm::vec3 center, glm::vec3 size, WorldPartType type) {
+    WorldPart part;
+    part.center = center;
+    part.size = size;
+    part.type = type;
+    return part;
+}
+
+// Trees, bushes, houses and towers: parts relative to the object's base position
+static WorldPart getPlacedObjectPart(int type, glm::vec3 pos, size_t sub) {
+    switch (type) {
+    case OBJECT_TREE:
+        if (sub == 0) return makePart(pos + glm::vec3(0.0f, TREE_TRUNK_HEIGHT * 0.5f, 0.0f), glm::vec3(TREE_TRUNK_RADIUS * 2.0f, TREE_TRUNK_HEIGHT, TREE_TRUNK_RADIUS * 2.0f), PART_TREE_TRUNK);
+        return makePart(pos + glm::vec3(0.0f, TREE_TRUNK_HEIGHT + 0.75f, 0.0f), glm::vec3(1.5f, 1.5f, 1.5f), PART_TREE_LEAVES);
+    case OBJECT_BUSH:
+        return makePart(pos + glm::vec3(0.0f, BUSH_SCALE * 0.5f, 0.0f), glm::vec3(BUSH_SCALE), PART_BUSH);
+    case OBJECT_HOUSE: {
+        glm::vec3 bodyCenterPos = pos + glm::vec3(0.0f, HOUSE_BODY_HEIGHT * 0.5f, 0.0f);
+        switch (sub) {
+        case 0: return makePart(bodyCenterPos, glm::vec3(HOUSE_BODY_WIDTH, HOUSE_BODY_HEIGHT, HOUSE_BODY_DEPTH), PART_HOUSE_BODY);
+        case 1: return makePart(bodyCenterPos + glm::vec3(0.0f, HOUSE_BODY_HEIGHT * 0.5f + HOUSE_ROOF_HEIGHT * 0.5f, 0.0f),
+                                glm::vec3(HOUSE_BODY_WIDTH + HOUSE_ROOF_OVERHANG * 2.0f, HOUSE_ROOF_HEIGHT, HOUSE_BODY_DEPTH + HOUSE_ROOF_OVERHANG * 2.0f), PART_HOUSE_ROOF);
+        case 2: return makePart(bodyCenterPos + glm::vec3(0.0f, -HOUSE_BODY_HEIGHT * 0.5f + HOUSE_DOOR_HEIGHT * 0.5f, HOUSE_BODY_DEPTH * 0.5f + 0.01f),
+                                glm::vec3(HOUSE_DOOR_WIDTH, HOUSE_DOOR_HEIGHT, 0.1f), PART_HOUSE_DOOR);
+        case 3: return makePart(bodyCenterPos + glm::vec3(HOUSE_BODY_WIDTH * 0.25f, 0.0f, HOUSE_BODY_DEPTH * 0.5f + 0.01f),
+                                glm::vec3(HOUSE_WINDOW_SIZE, HOUSE_WINDOW_SIZE, 0.1f), PART_HOUSE_WINDOW);
+        default: return makePart(bodyCenterPos + glm::vec3(HOUSE_BODY_WIDTH * 0.5f + 0.01f, 0.0f, 0.0f),
+                                 glm::vec3(0.1f, HOUSE_WINDOW_SIZE, HOUSE_WINDOW_SIZE), PART_HOUSE_WINDOW);
+        }
+    }
+    default:
+        return makePart(pos + glm::vec3(0.0f, TOWER_HEIGHT * 0.5f, 0.0f), glm::vec3(TOWER_WIDTH, TOWER_HEIGHT, TOWER_DEPTH), PART_TOWER);
+    }
+}
+
+// Railings are relative to the balcony center
+static WorldPart getBalconyPart(const Balcony& bal, size_t sub) {
+    switch (sub) {
+    case 0: return makePart(bal.position, bal.dimensions, PART_BALCONY_FLOOR);
+    case 1: return makePart(bal.position + bal.railingFrontPosRel, bal.railingDimsFront, PART_BALCONY_RAILING);
+    case 2: return makePart(bal.position + bal.railingLeftPosRel, bal.railingDimsSide, PART_BALCONY_RAILING);
+    default: return makePart(bal.position + bal.railingRightPosRel, bal.railingDimsSide, PART_BALCONY_RAILING);
+    }
+}
+
+static WorldPart getObjectPart(int type, size_t object, size_t sub) {
+    switch (type) {
+    case OBJECT_GROUND:
+        return makePart(glm::vec3(0.0f, -0.5f, 0.0f), glm::vec3(GROUND_SIZE, 0.1f, GROUND_SIZE), PART_GROUND); // Keep visual center
+    case OBJECT_SUN:
+        return makePart(SUN_POSITION, glm::vec3(SUN_SIZE), PART_SUN);
+    case OBJECT_TREE: return getPlacedObjectPart(type, treePositions[object], sub);
+    case OBJECT_BUSH: return getPlacedObjectPart(type, bushPositions[object], sub);
+    case OBJECT_HOUSE: return getPlacedObjectPart(type, housePositions[object], sub);
+    case OBJECT_TOWER: return getPlacedObjectPart(type, apartmentTowerPositions[object], sub);
+    default: return getBalconyPart(balconyData[object], sub);
+    }
+}
+
+size_t countWorldParts(size_t* countsByType) {
+    if (countsByType) {
+        for (int i = 0; i < PART_COUNT; ++i) countsByType[i] = 0;
+        countsByType[PART_GROUND] = 1;
+        countsByType[PART_SUN] = 1;
+        countsByType[PART_TREE_TRUNK] = countsByType[PART_TREE_LEAVES] = treePositions.size();
+        countsByType[PART_BUSH] = bushPositions.size();
+        countsByType[PART_HOUSE_BODY] = countsByType[PART_HOUSE_ROOF] = countsByType[PART_HOUSE_DOOR] = housePositions.size();
+        countsByType[PART_HOUSE_WINDOW] = housePositions.size() * 2;
+        countsByType[PART_TOWER] = apartmentTowerPositions.size();
+        countsByType[PART_BALCONY_FLOOR] = balconyData.size();
+        countsByType[PART_BALCONY_RAILING] = balconyData.size() * 3;
+    }
+    size_t total = 0;
+    for (int type = 0; type < OBJECT_TYPE_COUNT; ++type) total += getWorldObjectCount(static_cast<WorldObjectType>(type)) * WORLD_OBJECT_PART_COUNTS[type];
+    return total;
+}
+
+glm::mat4 getWorldPartModelMatrix(const WorldPart& part) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, part.center);
+    model = glm::scale(model, part.size);
+    return model;
+}
+
+void getWorldObjectParts(WorldObjectType type, size_t index, WorldPart* out) {
+    for (size_t sub = 0; sub < WORLD_OBJECT_PART_COUNTS[type]; ++sub) out[sub] = getObjectPart(type, index, sub);
+}
+
+void getPlacedObjectParts(WorldObjectType type, glm::vec3 basePosition, WorldPart* out) {
+    for (size_t sub = 0; sub < WORLD_OBJECT_PART_COUNTS[type]; ++sub) out[sub] = getPlacedObjectPart(type, basePosition, sub);
+}
+
+void getBalconyParts(const Balcony& balcony, WorldPart* out) {
+    for (size_t sub = 0; sub < WORLD_OBJECT_PART_COUNTS[OBJECT_BALCONY]; ++sub) out[sub] = getBalconyPart(balcony, sub);
+}
+
+size_t getWorldParts(size_t first, size_t count, WorldPart* out) {
+    size_t written = 0;
+    size_t sectionStart = 0;
+    for (int type = 0; type < OBJECT_TYPE_COUNT && written < count; ++type) {
+        size_t perObject = WORLD_OBJECT_PART_COUNTS[type];
+        size_t sectionParts = getWorldObjectCount(static_cast<WorldObjectType>(type)) * perObject;
+        size_t position = first + written; // Never before sectionStart: earlier sections are skipped or filled
+        if (position < sectionStart + sectionParts) {
+            for (size_t local = position - sectionStart; local < sectionParts && written < count; ++local) {
+                out[written++] = getObjectPart(type, local / perObject, local % perObject);
+            }
+        }
+        sectionStart += sectionParts;
+    }
+    return written;
+}
+
+
+// --- World Editing ---
+static WorldPositions* editablePositions(WorldObjectType type) {
+    switch (type) {
+    case OBJECT_TREE: return &treePositions;
+    case OBJECT_BUSH: return &bushPositions;
+    case OBJECT_HOUSE: return &housePositions;
+    default: return NULL;
+    }
+}
+
+bool isWorldObjectEditable(WorldObjectType type) {
+    return editablePositions(type) != NULL;
+}
+
+size_t addWorldObject(WorldObjectType type, glm::vec3 basePosition) {
+    WorldPositions* positions = editablePositions(type);
+    if (!positions) {
+        std::cerr << "ERROR::WORLD::OBJECT_NOT_EDITABLE " << type << std::endl;
+        return 0;
+    }
+    ensureCollisionGrid();
+    size_t index = positions->size();
+    positions->push_back(basePosition);
+    colliderCellSlots[type].push_back(0);
+    insertCollider(type, index);
+    return index;
+}
+
+size_t removeWorldObject(WorldObjectType type, size_t index) {
+    WorldPositions* positions = editablePositions(type);
+    if (!positions || index >= positions->size()) {
+        std::cerr << "ERROR::WORLD::INVALID_OBJECT_REMOVAL " << type << " " << index << std::endl;
+        return index;
+    }
+    ensureCollisionGrid();
+    eraseCollider(type, index);
+    size_t last = positions->size() - 1;
+    if (index != last) {
+        // Move the last object into the hole and repoint its grid entry
+        uint32_t slot = colliderCellSlots[type][last];
+        collisionCellAt((*positions)[last])[slot].index = static_cast<uint32_t>(index);
+        colliderCellSlots[type][index] = slot;
+        (*positions)[index] = (*positions)[last];
+    }
+    positions->pop_back();
+    colliderCellSlots[type].pop_back();
+    return last;
+}
+
+// Slab test; `t` is the entry distance, 0 if the origin is inside the box
+static bool rayHitsBox(glm::vec3 origin, glm::vec3 invDir, glm::vec3 boxMin, glm::vec3 boxMax, float maxDistance, float& t) {
+    glm::vec3 t1 = (boxMin - origin) * invDir;
+    glm::vec3 t2 = (boxMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t1, t2);
+    glm::vec3 tFar = glm::max(t1, t2);
+    float enter = glm::max(glm::max(tNear.x, tNear.y), glm::max(tNear.z, 0.0f));
+    float exit = glm::min(glm::min(tFar.x, tFar.y), glm::min(tFar.z, maxDistance));
+    if (enter > exit) return false;
+    t = enter;
+    return true;
+}
+
+bool pickWorldObject(glm::vec3 origin, glm::vec3 direction, float maxDistance, WorldObjectType* type, size_t* index, float* distance) {
+    ensureCollisionGrid();
+    glm::vec3 invDir = 1.0f / direction;
+    glm::vec3 end = origin + direction * maxDistance;
+    int minX = collisionCellCoord(glm::min(origin.x, end.x) - COLLIDER_MAX_HALF_EXTENT);
+    int maxX = collisionCellCoord(glm::max(origin.x, end.x) + COLLIDER_MAX_HALF_EXTENT);
+    int minZ = collisionCellCoord(glm::min(origin.z, end.z) - COLLIDER_MAX_HALF_EXTENT);
+    int maxZ = collisionCellCoord(glm::max(origin.z, end.z) + COLLIDER_MAX_HALF_EXTENT);
+
+    float nearest = maxDistance;
+    const ColliderRef* nearestRef = NULL;
+    WorldPart parts[MAX_PARTS_PER_OBJECT];
+    for (int z = minZ; z <= maxZ; ++z) {
+        for (int x = minX; x <= maxX; ++x) {
+            for (const ColliderRef& ref : collisionCells[z * collisionGridDim + x]) {
+                WorldObjectType refType = static_cast<WorldObjectType>(ref.type);
+                getWorldObjectParts(refType, ref.index, parts);
+                for (size_t p = 0; p < WORLD_OBJECT_PART_COUNTS[refType]; ++p) {
+                    float t;
+                    glm::vec3 halfSize = parts[p].size * 0.5f;
+                    if (rayHitsBox(origin, invDir, parts[p].center - halfSize, parts[p].center + halfSize, nearest, t) && (t < nearest || !nearestRef)) {
+                        nearest = t;
+                        nearestRef = &ref;
+                    }
+                }
+            }
+        }
+    }
+    if (!nearestRef || !isWorldObjectEditable(static_cast<WorldObjectType>(nearestRef->type))) return false;
+    *type = static_cast<WorldObjectType>(nearestRef->type);
+    *index = nearestRef->index;
+    if (distance) *distance = nearest;
+    return true;
+}
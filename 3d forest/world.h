@@ -0,0 +1,187 @@
+// World data shared by the renderer and the CPU-side queries (collision, ray casts):
+// configuration constants, generated object positions and the generation/collision routines.
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "memory.h"
+
+// --- World Configuration ---
+const float GROUND_SIZE = 500.0f;
+const int TREE_COUNT = 800;
+const int BUSH_COUNT = 1500; // Bushes currently don't have collision
+const int HOUSE_COUNT = 50;
+const int APARTMENT_TOWER_COUNT = 25; // Number of apartment towers
+
+// --- Physics & Player ---
+const float GRAVITY = 9.81f * 2.0f; // Adjusted gravity strength
+const float JUMP_FORCE = 8.0f;
+const float PLAYER_EYE_HEIGHT = 1.7f; // How high the camera is off the player's feet
+const float PLAYER_RADIUS = 0.3f;     // Player's collision radius for horizontal checks
+const float GROUND_LEVEL = -0.45f;    // Y-coordinate of the ground surface (-0.5f center + 0.1f/2 scale)
+const float PLAYER_BASE_SPEED = 5.0f; // *** Base walking/flying speed ***
+const float SPRINT_MULTIPLIER = 1.8f; // *** Speed multiplier when sprinting/flying faster ***
+const float FLY_VERTICAL_SPEED = 4.0f; // Speed for moving up/down in fly mode
+
+// --- Object Dimensions for Collision & Rendering ---
+const float TREE_TRUNK_RADIUS = 0.25f; // Half the scale width of the trunk (0.5f / 2)
+const float TREE_TRUNK_HEIGHT = 2.0f; // Scale height of the trunk
+const float HOUSE_BODY_WIDTH = 4.0f;
+const float HOUSE_BODY_DEPTH = 5.0f;
+const float HOUSE_BODY_HEIGHT = 3.0f; // Used for potential future vertical collision
+const float TOWER_WIDTH = 8.0f;
+const float TOWER_DEPTH = 8.0f;
+const float TOWER_HEIGHT = 40.0f; // Significantly taller than houses
+
+// --- NEW: Balcony Dimensions ---
+const float BALCONY_WIDTH = 2.5f;
+const float BALCONY_DEPTH = 1.5f;
+const float BALCONY_FLOOR_HEIGHT = 0.2f; // Thickness of the balcony floor
+const float BALCONY_RAILING_HEIGHT = 0.8f;
+const float BALCONY_RAILING_THICKNESS = 0.1f;
+const int   BALCONIES_PER_TOWER = 3; // How many balconies per tower
+
+// --- NEW: Sun Configuration ---
+const float SUN_DISTANCE_FACTOR = 0.7f; // How far out relative to ground size
+const float SUN_HEIGHT_FACTOR = 0.6f;   // How high relative to ground size
+const float SUN_SIZE = 30.0f;           // Scale factor for the sun cube
+const glm::vec3 SUN_COLOR = glm::vec3(1.0f, 0.95f, 0.7f); // Bright yellowish color
+const glm::vec3 SUN_POSITION = glm::vec3(GROUND_SIZE * SUN_DISTANCE_FACTOR, GROUND_SIZE * SUN_HEIGHT_FACTOR, -GROUND_SIZE * SUN_DISTANCE_FACTOR); // Fixed position
+
+// --- Object Positions (Global for Collision Checks) ---
+// Each array lives in its own MEMORY_WORLD arena, released in bulk when it is regenerated.
+typedef ArenaVector<glm::vec3> WorldPositions;
+extern WorldPositions treePositions;
+extern WorldPositions bushPositions;
+extern WorldPositions housePositions;
+extern WorldPositions apartmentTowerPositions; // Vector for tower positions
+
+// --- NEW: Balcony Data Structure and Global Vector ---
+struct Balcony {
+    glm::vec3 position; // World space center position of the balcony floor
+    glm::vec3 dimensions; // Width, Height (floor thickness), Depth
+    // Store railing positions relative to the center for easier drawing/collision
+    glm::vec3 railingFrontPosRel;
+    glm::vec3 railingLeftPosRel;
+    glm::vec3 railingRightPosRel;
+    glm::vec3 railingDimsFront; // Width, Height, Thickness
+    glm::vec3 railingDimsSide;  // Thickness, Height, Depth
+};
+extern ArenaVector<Balcony> balconyData; // Global vector to store all balconies
+
+// --- Global Settings (set by the seed dialog on Windows) ---
+extern unsigned int g_seed;
+extern bool g_flyModeEnabled; // *** NEW: Global flag for fly mode ***
+
+// --- World Parts ---
+// Every object is built from axis-aligned unit cubes. Parts are enumerated in a fixed order
+// (ground, sun, trees, bushes, houses, towers, balconies) straight from the position arrays,
+// so renderers and exporters can pull any range without materializing the whole scene.
+enum WorldPartType {
+    PART_GROUND = 0,
+    PART_SUN,
+    PART_TREE_TRUNK,
+    PART_TREE_LEAVES,
+    PART_BUSH,
+    PART_HOUSE_BODY,
+    PART_HOUSE_ROOF,
+    PART_HOUSE_DOOR,
+    PART_HOUSE_WINDOW,
+    PART_TOWER,
+    PART_BALCONY_FLOOR,
+    PART_BALCONY_RAILING,
+    PART_COUNT
+};
+struct WorldPart {
+    glm::vec3 center;
+    glm::vec3 size; // Scale applied to the unit cube
+    WorldPartType type;
+};
+extern const glm::vec3 WORLD_PART_COLORS[PART_COUNT];
+extern const char* const WORLD_PART_NAMES[PART_COUNT];
+
+// Total part count; optionally also per type.
+size_t countWorldParts(size_t* countsByType = NULL);
+// Writes parts [first, first + count) to `out`, returns how many were written.
+size_t getWorldParts(size_t first, size_t count, WorldPart* out);
+// Model matrix that turns the unit cube into this part
+glm::mat4 getWorldPartModelMatrix(const WorldPart& part);
+
+// --- World Objects ---
+// The sections of the part enumeration; every object of a type has the same part count.
+enum WorldObjectType {
+    OBJECT_GROUND = 0,
+    OBJECT_SUN,
+    OBJECT_TREE,
+    OBJECT_BUSH,
+    OBJECT_HOUSE,
+    OBJECT_TOWER,
+    OBJECT_BALCONY,
+    OBJECT_TYPE_COUNT
+};
+const size_t MAX_PARTS_PER_OBJECT = 5;
+extern const size_t WORLD_OBJECT_PART_COUNTS[OBJECT_TYPE_COUNT];
+
+size_t getWorldObjectCount(WorldObjectType type);
+// Writes the WORLD_OBJECT_PART_COUNTS[type] parts of one object to `out`.
+void getWorldObjectParts(WorldObjectType type, size_t index, WorldPart* out);
+// The same for objects outside the globals: a tree, bush, house or tower at `basePosition`, or a balcony
+void getPlacedObjectParts(WorldObjectType type, glm::vec3 basePosition, WorldPart* out);
+void getBalconyParts(const Balcony& balcony, WorldPart* out);
+
+// --- Seed Streams ---
+// Each generated category draws from its own stream, derived from the world seed with a
+// portable generator (SplitMix64), so changing one category's parameters leaves the others
+// alone and a seed gives the same world with every compiler and standard library.
+enum WorldSeedStream {
+    SEED_STREAM_TREES = 1,
+    SEED_STREAM_BUSHES,
+    SEED_STREAM_HOUSES,
+    SEED_STREAM_TOWERS,
+    SEED_STREAM_BALCONIES,
+    SEED_STREAM_QUERIES // Not part of any world: benchmark positions and edits
+};
+struct WorldRandom {
+    uint64_t state;
+};
+// `variation` re-rolls one stream without touching the rest (0 for the seed's own world)
+WorldRandom makeWorldRandom(unsigned int seed, WorldSeedStream stream, uint32_t variation = 0);
+// Independent child stream, e.g. one per tower so its balconies don't depend on the tower count
+WorldRandom forkWorldRandom(const WorldRandom& parent, uint32_t index);
+float worldRandomFloat(WorldRandom& random);                    // [0, 1)
+uint32_t worldRandomIndex(WorldRandom& random, uint32_t range); // [0, range)
+
+// --- World Generation & Collision ---
+// Positions are drawn in order, so a larger count keeps the first objects where they were.
+// `positions` must be the only user of its arena. Touches no globals: callers filling the
+// global arrays call invalidateCollisionGrid().
+void generateObjectPositions(WorldPositions& positions, float areaSize, int count, WorldRandom& random);
+// Balconies for the current apartmentTowerPositions; tower i uses forkWorldRandom(random, i).
+void generateBalconies(int balconiesPerTower, const WorldRandom& random);
+// The same into `balconies` for any tower array, touching no globals, so worlds can be
+// generated on several threads. `balconies` must be the only user of its arena.
+void generateBalconies(ArenaVector<Balcony>& balconies, const WorldPositions& towers, int balconiesPerTower, const WorldRandom& random);
+void generateTowersAndBalconies(float areaSize, int towerCount, int balconiesPerTower, unsigned int seed);
+void generateWorld(unsigned int seed); // Every category with the default counts; see world_graph.h for partial regeneration
+bool checkCollision(glm::vec3 nextPos); // Collision detection function
+
+// --- Collision Grid ---
+// checkCollision() and pickWorldObject() only visit objects bucketed in nearby XZ cells.
+// The grid covers the ground, or the generated objects if they spread further; objects placed
+// beyond its edge later share the border cells. It is rebuilt lazily after generation and
+// patched in place by the edit functions below.
+const float COLLISION_CELL_SIZE = 8.0f;
+void invalidateCollisionGrid(); // After regenerating any of the global position arrays
+
+// --- World Editing ---
+// Trees, bushes and houses can be added and removed at runtime in O(1). Removal moves the
+// last object of that type into the freed index, so indices are not stable across edits.
+bool isWorldObjectEditable(WorldObjectType type);
+size_t addWorldObject(WorldObjectType type, glm::vec3 basePosition); // Returns the new index
+// Returns the previous index of the object that now occupies `index` (`index` itself if none moved).
+size_t removeWorldObject(WorldObjectType type, size_t index);
+// Nearest object hit by the ray within maxDistance. Returns false if nothing is hit or the
+// nearest hit is not editable (towers and balconies block picking).
+bool pickWorldObject(glm::vec3 origin, glm::vec3 direction, float maxDistance, WorldObjectType* type, size_t* index, float* distance = NULL);
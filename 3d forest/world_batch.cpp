@@ -0,0 +1,380 @@
+#include "world_batch.h"
+#include "export.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+const char* const BATCH_CATEGORY_NAMES[BATCH_CATEGORY_COUNT] = { "trees", "bushes", "houses", "towers", "balconies" };
+const char* const BALCONY_SIDE_NAMES[BALCONY_SIDE_COUNT] = { "pos_z", "neg_z", "pos_x", "neg_x" };
+
+// Parts closer than this are touching, not overlapping (doors and windows sit 0.01 m out)
+static const float BATCH_OVERLAP_EPSILON = 1e-3f;
+
+static const WorldObjectType BATCH_OBJECT_TYPES[BATCH_CATEGORY_COUNT] = { OBJECT_TREE, OBJECT_BUSH, OBJECT_HOUSE, OBJECT_TOWER, OBJECT_BALCONY };
+
+// One object of a batch world: its bounds and its parts (parts[firstPart, firstPart + partCount))
+struct BatchObject {
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    uint32_t firstPart;
+    uint8_t partCount;
+    uint8_t category;  // BatchCategory
+    uint32_t index;    // Within its category
+};
+
+// A world generated outside the globals, plus the scratch arrays its statistics need. Each
+// worker thread keeps one and reuses its memory from seed to seed.
+struct BatchWorld {
+    WorldPositions positions[BATCH_TOWERS + 1]; // Trees, bushes, houses, towers (heap-backed)
+    ArenaVector<Balcony> balconies;
+    std::vector<BatchObject> objects;
+    std::vector<WorldPart> parts;
+    std::vector<uint32_t> order;
+    std::vector<uint8_t> blocked;               // Per balcony
+    std::vector<size_t> regionCounts;
+};
+
+// --- Generation ---
+// The same streams and order as the generation graph with no variations, so every seed gives
+// exactly the world the game shows for it
+static void generateBatchWorld(BatchWorld& world, const WorldGenParams& params) {
+    const WorldSeedStream streams[] = { SEED_STREAM_TREES, SEED_STREAM_BUSHES, SEED_STREAM_HOUSES, SEED_STREAM_TOWERS };
+    const int counts[] = { params.treeCount, params.bushCount, params.houseCount, params.towerCount };
+    for (int category = BATCH_TREES; category <= BATCH_TOWERS; ++category) {
+        WorldRandom random = makeWorldRandom(params.seed, streams[category]);
+        generateObjectPositions(world.positions[category], params.areaSize, counts[category], random);
+    }
+    generateBalconies(world.balconies, world.positions[BATCH_TOWERS], params.balconiesPerTower, makeWorldRandom(params.seed, SEED_STREAM_BALCONIES));
+}
+
+// --- Statistics ---
+static void addBatchObject(BatchWorld& world, BatchCategory category, uint32_t index, const WorldPart* parts) {
+    BatchObject object;
+    object.boundsMin = glm::vec3(INFINITY);
+    object.boundsMax = glm::vec3(-INFINITY);
+    object.firstPart = static_cast<uint32_t>(world.parts.size());
+    object.partCount = static_cast<uint8_t>(WORLD_OBJECT_PART_COUNTS[BATCH_OBJECT_TYPES[category]]);
+    object.category = static_cast<uint8_t>(category);
+    object.index = index;
+    for (uint8_t p = 0; p < object.partCount; ++p) {
+        object.boundsMin = glm::min(object.boundsMin, parts[p].center - parts[p].size * 0.5f);
+        object.boundsMax = glm::max(object.boundsMax, parts[p].center + parts[p].size * 0.5f);
+        world.parts.push_back(parts[p]);
+    }
+    world.objects.push_back(object);
+}
+
+static bool boxesOverlap(glm::vec3 minA, glm::vec3 maxA, glm::vec3 minB, glm::vec3 maxB) {
+    return minA.x < maxB.x - BATCH_OVERLAP_EPSILON && minB.x < maxA.x - BATCH_OVERLAP_EPSILON &&
+           minA.y < maxB.y - BATCH_OVERLAP_EPSILON && minB.y < maxA.y - BATCH_OVERLAP_EPSILON &&
+           minA.z < maxB.z - BATCH_OVERLAP_EPSILON && minB.z < maxA.z - BATCH_OVERLAP_EPSILON;
+}
+
+static bool objectsOverlap(const BatchWorld& world, const BatchObject& a, const BatchObject& b) {
+    if (!boxesOverlap(a.boundsMin, a.boundsMax, b.boundsMin, b.boundsMax)) return false;
+    for (uint32_t i = a.firstPart; i < a.firstPart + a.partCount; ++i) {
+        glm::vec3 halfA = world.parts[i].size * 0.5f;
+        for (uint32_t j = b.firstPart; j < b.firstPart + b.partCount; ++j) {
+            glm::vec3 halfB = world.parts[j].size * 0.5f;
+            if (boxesOverlap(world.parts[i].center - halfA, world.parts[i].center + halfA, world.parts[j].center - halfB, world.parts[j].center + halfB)) return true;
+        }
+    }
+    return false;
+}
+
+// Sweep and prune along X: objects sorted by their left edge only meet the ones that start
+// before they end
+static void countOverlaps(BatchWorld& world, const WorldGenParams& params, BatchWorldStats& stats) {
+    world.order.resize(world.objects.size());
+    for (uint32_t i = 0; i < world.order.size(); ++i) world.order[i] = i;
+    std::sort(world.order.begin(), world.order.end(), [&world](uint32_t a, uint32_t b) {
+        return world.objects[a].boundsMin.x < world.objects[b].boundsMin.x;
+    });
+    world.blocked.assign(world.balconies.size(), 0);
+
+    for (size_t i = 0; i < world.order.size(); ++i) {
+        const BatchObject& a = world.objects[world.order[i]];
+        for (size_t j = i + 1; j < world.order.size(); ++j) {
+            const BatchObject& b = world.objects[world.order[j]];
+            if (b.boundsMin.x >= a.boundsMax.x - BATCH_OVERLAP_EPSILON) break;
+            const BatchObject& low = a.category <= b.category ? a : b;
+            const BatchObject& high = a.category <= b.category ? b : a;
+            // A balcony is attached to its own tower
+            if (low.category == BATCH_TOWERS && high.category == BATCH_BALCONIES &&
+                high.index / static_cast<uint32_t>(params.balconiesPerTower) == low.index) continue;
+            if (!objectsOverlap(world, a, b)) continue;
+
+            stats.overlaps[low.category][high.category]++;
+            stats.totalOverlaps++;
+            if (a.category == BATCH_BALCONIES) world.blocked[a.index] = 1;
+            if (b.category == BATCH_BALCONIES) world.blocked[b.index] = 1;
+        }
+    }
+    for (uint8_t blocked : world.blocked) stats.blockedBalconies += blocked;
+}
+
+static void measureDensity(BatchWorld& world, const WorldGenParams& params, int regions, BatchWorldStats& stats) {
+    world.regionCounts.assign(static_cast<size_t>(regions) * regions, 0);
+    float regionSize = params.areaSize / regions;
+    for (int category = BATCH_TREES; category <= BATCH_TOWERS; ++category) {
+        for (const glm::vec3& position : world.positions[category]) {
+            int x = std::min(regions - 1, std::max(0, static_cast<int>((position.x + params.areaSize * 0.5f) / regionSize)));
+            int z = std::min(regions - 1, std::max(0, static_cast<int>((position.z + params.areaSize * 0.5f) / regionSize)));
+            world.regionCounts[z * regions + x]++;
+        }
+    }
+
+    float hectares = regionSize * regionSize / BATCH_HECTARE;
+    stats.regionDensity.resize(world.regionCounts.size());
+    double sum = 0.0, sumSquares = 0.0;
+    for (size_t r = 0; r < world.regionCounts.size(); ++r) {
+        float density = world.regionCounts[r] / hectares;
+        stats.regionDensity[r] = density;
+        sum += density;
+        sumSquares += static_cast<double>(density) * density;
+    }
+    stats.densityMin = *std::min_element(stats.regionDensity.begin(), stats.regionDensity.end());
+    stats.densityMax = *std::max_element(stats.regionDensity.begin(), stats.regionDensity.end());
+    double mean = sum / stats.regionDensity.size();
+    double variance = std::max(0.0, sumSquares / stats.regionDensity.size() - mean * mean);
+    stats.densityMean = static_cast<float>(mean);
+    stats.densityVariation = mean > 0.0 ? static_cast<float>(std::sqrt(variance) / mean) : 0.0f;
+}
+
+static BalconySide getBalconySide(const Balcony& balcony, glm::vec3 towerPosition) {
+    glm::vec3 offset = balcony.position - towerPosition;
+    if (std::abs(offset.z) > std::abs(offset.x)) return offset.z > 0.0f ? BALCONY_SIDE_POS_Z : BALCONY_SIDE_NEG_Z;
+    return offset.x > 0.0f ? BALCONY_SIDE_POS_X : BALCONY_SIDE_NEG_X;
+}
+
+static void measureBalconies(const BatchWorld& world, const WorldGenParams& params, BatchWorldStats& stats) {
+    const WorldPositions& towers = world.positions[BATCH_TOWERS];
+    size_t perTower = static_cast<size_t>(params.balconiesPerTower);
+    for (size_t tower = 0; tower < towers.size() && perTower > 0; ++tower) {
+        BalconySide firstSide = getBalconySide(world.balconies[tower * perTower], towers[tower]);
+        bool oneSided = perTower > 1;
+        for (size_t b = tower * perTower; b < (tower + 1) * perTower; ++b) {
+            BalconySide side = getBalconySide(world.balconies[b], towers[tower]);
+            stats.balconySides[side]++;
+            oneSided = oneSided && side == firstSide;
+        }
+        if (oneSided) stats.oneSidedTowers++;
+    }
+}
+
+static void measureBatchWorld(BatchWorld& world, const WorldGenParams& params, int regions, BatchWorldStats& stats) {
+    world.objects.clear();
+    world.parts.clear();
+    WorldPart parts[MAX_PARTS_PER_OBJECT];
+    for (int category = BATCH_TREES; category <= BATCH_TOWERS; ++category) {
+        const WorldPositions& positions = world.positions[category];
+        stats.objects[category] = positions.size();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            getPlacedObjectParts(BATCH_OBJECT_TYPES[category], positions[i], parts);
+            addBatchObject(world, static_cast<BatchCategory>(category), static_cast<uint32_t>(i), parts);
+        }
+    }
+    stats.objects[BATCH_BALCONIES] = world.balconies.size();
+    for (size_t i = 0; i < world.balconies.size(); ++i) {
+        getBalconyParts(world.balconies[i], parts);
+        addBatchObject(world, BATCH_BALCONIES, static_cast<uint32_t>(i), parts);
+    }
+
+    countOverlaps(world, params, stats);
+    measureDensity(world, params, regions, stats);
+    measureBalconies(world, params, stats);
+}
+
+// --- Batch ---
+void runWorldBatch(const BatchOptions& options, BatchRun& run) {
+    auto start = std::chrono::steady_clock::now();
+    run.worlds.assign(options.seedCount, BatchWorldStats());
+    run.threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    run.threads = std::max(1u, std::min(run.threads, options.seedCount));
+
+    // Workers pull seeds one at a time; a world takes about a millisecond, so this stays balanced
+    std::atomic<unsigned int> nextWorld(0);
+    auto worker = [&]() {
+        BatchWorld world;
+        for (unsigned int i = nextWorld.fetch_add(1); i < options.seedCount; i = nextWorld.fetch_add(1)) {
+            BatchWorldStats& stats = run.worlds[i];
+            stats.seed = options.firstSeed + i;
+            WorldGenParams params = makeScaledWorldGenParams(stats.seed, options.scale);
+            auto generateStart = std::chrono::steady_clock::now();
+            generateBatchWorld(world, params);
+            auto statsStart = std::chrono::steady_clock::now();
+            measureBatchWorld(world, params, options.regions, stats);
+            stats.generateMs = std::chrono::duration<double, std::milli>(statsStart - generateStart).count();
+            stats.statsMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - statsStart).count();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(run.threads - 1);
+    for (unsigned int t = 1; t < run.threads; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.worldsPerSecond = run.seconds > 0.0 ? options.seedCount / run.seconds : 0.0;
+}
+
+// --- Output ---
+void writeWorldBatch(std::ostream& out, const BatchOptions& options, const BatchRun& run, bool csv) {
+    std::streamsize oldPrecision = out.precision(6);
+    if (csv) {
+        out << "seed";
+        for (const char* name : BATCH_CATEGORY_NAMES) out << ',' << name;
+        out << ",overlaps";
+        for (int a = 0; a < BATCH_CATEGORY_COUNT; ++a) {
+            for (int b = a; b < BATCH_CATEGORY_COUNT; ++b) out << ",overlaps_" << BATCH_CATEGORY_NAMES[a] << '_' << BATCH_CATEGORY_NAMES[b];
+        }
+        out << ",density_min,density_max,density_mean,density_variation";
+        for (int r = 0; r < options.regions * options.regions; ++r) out << ",density_region_" << r;
+        for (const char* name : BALCONY_SIDE_NAMES) out << ",balconies_" << name;
+        out << ",one_sided_towers,blocked_balconies,generate_ms,stats_ms\n";
+        for (const BatchWorldStats& w : run.worlds) {
+            out << w.seed;
+            for (size_t count : w.objects) out << ',' << count;
+            out << ',' << w.totalOverlaps;
+            for (int a = 0; a < BATCH_CATEGORY_COUNT; ++a) {
+                for (int b = a; b < BATCH_CATEGORY_COUNT; ++b) out << ',' << w.overlaps[a][b];
+            }
+            out << ',' << w.densityMin << ',' << w.densityMax << ',' << w.densityMean << ',' << w.densityVariation;
+            for (float density : w.regionDensity) out << ',' << density;
+            for (size_t count : w.balconySides) out << ',' << count;
+            out << ',' << w.oneSidedTowers << ',' << w.blockedBalconies << ',' << w.generateMs << ',' << w.statsMs << '\n';
+        }
+    }
+    else {
+        out << "{\n  \"scale\": " << options.scale << ", \"regions\": " << options.regions << ", \"threads\": " << run.threads
+            << ", \"seconds\": " << run.seconds << ", \"worlds_per_second\": " << run.worldsPerSecond << ",\n  \"worlds\": [\n";
+        for (size_t i = 0; i < run.worlds.size(); ++i) {
+            const BatchWorldStats& w = run.worlds[i];
+            out << "    {\"seed\": " << w.seed << ", \"objects\": {";
+            for (int c = 0; c < BATCH_CATEGORY_COUNT; ++c) out << (c ? ", " : "") << '"' << BATCH_CATEGORY_NAMES[c] << "\": " << w.objects[c];
+            out << "},\n     \"overlaps\": {\"total\": " << w.totalOverlaps;
+            for (int a = 0; a < BATCH_CATEGORY_COUNT; ++a) {
+                for (int b = a; b < BATCH_CATEGORY_COUNT; ++b) out << ", \"" << BATCH_CATEGORY_NAMES[a] << '_' << BATCH_CATEGORY_NAMES[b] << "\": " << w.overlaps[a][b];
+            }
+            out << "},\n     \"density_per_ha\": {\"min\": " << w.densityMin << ", \"max\": " << w.densityMax << ", \"mean\": " << w.densityMean
+                << ", \"variation\": " << w.densityVariation << ", \"regions\": [";
+            for (size_t r = 0; r < w.regionDensity.size(); ++r) out << (r ? ", " : "") << w.regionDensity[r];
+            out << "]},\n     \"balconies\": {";
+            for (int s = 0; s < BALCONY_SIDE_COUNT; ++s) out << '"' << BALCONY_SIDE_NAMES[s] << "\": " << w.balconySides[s] << ", ";
+            out << "\"one_sided_towers\": " << w.oneSidedTowers << ", \"blocked\": " << w.blockedBalconies << "},\n     \"generate_ms\": "
+                << w.generateMs << ", \"stats_ms\": " << w.statsMs << "}" << (i + 1 < run.worlds.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+    out.precision(oldPrecision);
+    out.flush();
+}
+
+// --- Command Line ---
+// Writes each seed's world through the exporter. Uses the world globals, one seed at a time.
+// `log` is off when the results go to stdout, to keep it parseable.
+static bool writeCachedWorlds(const std::vector<unsigned int>& seeds, int scale, const std::string& directory, const std::string& extension, bool log) {
+    bool ok = true;
+    for (unsigned int seed : seeds) {
+        generateScaledWorld(seed, scale);
+        std::string path = directory + "/forest_" + std::to_string(seed) + "." + extension;
+        ExportStats stats;
+        if (!exportWorld(path, exportFormatForPath(path, false), &stats)) {
+            ok = false;
+            continue;
+        }
+        if (log) std::cout << "Cached seed " << seed << " to " << path << " (" << stats.bytesWritten << " bytes)" << std::endl;
+    }
+    return ok;
+}
+
+// "first" or "first-last": digits only, seeds within unsigned int, at most BATCH_MAX_SEEDS of them
+static bool parseSeedRange(const char* text, unsigned int* first, unsigned int* count) {
+    if (!std::isdigit(static_cast<unsigned char>(*text))) return false;
+    char* end = NULL;
+    unsigned long long low = std::strtoull(text, &end, 10), high = low;
+    if (*end == '-') {
+        const char* lastText = end + 1;
+        if (!std::isdigit(static_cast<unsigned char>(*lastText))) return false;
+        high = std::strtoull(lastText, &end, 10);
+    }
+    if (*end != '\0' || high < low || high > UINT_MAX || high - low >= BATCH_MAX_SEEDS) return false;
+    *first = static_cast<unsigned int>(low);
+    *count = static_cast<unsigned int>(high - low + 1);
+    return true;
+}
+
+int runWorldBatchCommand(int argc, char** argv) {
+    BatchOptions options;
+    bool csv = false;
+    std::string outPath, cacheDirectory = ".", cacheExtension = "glb";
+    std::vector<unsigned int> cacheSeeds;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seeds" && hasValue) {
+            if (!parseSeedRange(argv[++i], &options.firstSeed, &options.seedCount)) {
+                std::cerr << "ERROR::BATCH::BAD_SEED_RANGE " << argv[i] << " (first[-last], at most " << BATCH_MAX_SEEDS << " seeds)" << std::endl;
+                return -1;
+            }
+        }
+        else if (arg == "--scale" && hasValue) options.scale = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--regions" && hasValue) options.regions = std::min(BATCH_MAX_REGIONS, std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--threads" && hasValue) options.threads = static_cast<unsigned int>(std::strtoul(argv[++i], NULL, 10));
+        else if (arg == "--format" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "csv") csv = true;
+            else if (value != "json") {
+                std::cerr << "ERROR::BATCH::UNKNOWN_FORMAT " << value << std::endl;
+                return -1;
+            }
+        }
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--cache-seeds" && hasValue) {
+            for (const char* list = argv[++i]; *list;) {
+                char* end = NULL;
+                unsigned long seed = std::strtoul(list, &end, 10);
+                if (end == list) {
+                    std::cerr << "ERROR::BATCH::BAD_CACHE_SEEDS " << argv[i] << std::endl;
+                    return -1;
+                }
+                cacheSeeds.push_back(static_cast<unsigned int>(seed));
+                list = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (arg == "--cache-dir" && hasValue) cacheDirectory = argv[++i];
+        else if (arg == "--cache-format" && hasValue) {
+            cacheExtension = argv[++i];
+            if (cacheExtension != "glb" && cacheExtension != "obj") {
+                std::cerr << "ERROR::BATCH::UNKNOWN_CACHE_FORMAT " << cacheExtension << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    BatchRun run;
+    runWorldBatch(options, run);
+    if (outPath.empty()) {
+        writeWorldBatch(std::cout, options, run, csv);
+        return writeCachedWorlds(cacheSeeds, options.scale, cacheDirectory, cacheExtension, false) ? 0 : -1;
+    }
+
+    std::ofstream file(outPath.c_str());
+    if (!file) {
+        std::cerr << "ERROR::BATCH::CANNOT_OPEN " << outPath << std::endl;
+        return -1;
+    }
+    writeWorldBatch(file, options, run, csv);
+    std::cout << "Generated " << options.seedCount << " worlds (seeds " << options.firstSeed << " - " << options.firstSeed + options.seedCount - 1
+              << ", " << options.scale << "x) in " << run.seconds << " s on " << run.threads << " threads: " << run.worldsPerSecond
+              << " worlds/s. Results in " << outPath << std::endl;
+    return writeCachedWorlds(cacheSeeds, options.scale, cacheDirectory, cacheExtension, true) ? 0 : -1;
+}
@@ -0,0 +1,82 @@
+// Headless batch generation: generates a range of seeds on every core, without a window or GL,
+// and reports per-world statistics (object overlaps, density per region, balcony placement) as
+// JSON or CSV, for picking good layouts. Chosen seeds can also be written out as world files.
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "world.h"
+#include "world_graph.h"
+
+// --- Batch Configuration ---
+const int BATCH_DEFAULT_REGIONS = 4; // Density grid is this many regions per side
+const int BATCH_MAX_REGIONS = 64;
+const unsigned int BATCH_MAX_SEEDS = 100000; // Every seed's stats are allocated up front
+const float BATCH_HECTARE = 10000.0f; // Square meters
+
+// The five generated categories, indexing the per-category arrays below
+enum BatchCategory {
+    BATCH_TREES = 0,
+    BATCH_BUSHES,
+    BATCH_HOUSES,
+    BATCH_TOWERS,
+    BATCH_BALCONIES,
+    BATCH_CATEGORY_COUNT
+};
+extern const char* const BATCH_CATEGORY_NAMES[BATCH_CATEGORY_COUNT];
+
+// Balcony sides, in the order generateBalconies() numbers them
+enum BalconySide {
+    BALCONY_SIDE_POS_Z = 0,
+    BALCONY_SIDE_NEG_Z,
+    BALCONY_SIDE_POS_X,
+    BALCONY_SIDE_NEG_X,
+    BALCONY_SIDE_COUNT
+};
+extern const char* const BALCONY_SIDE_NAMES[BALCONY_SIDE_COUNT];
+
+struct BatchWorldStats {
+    unsigned int seed = 0;
+    size_t objects[BATCH_CATEGORY_COUNT] = {};
+    // Pairs of objects whose parts intersect, by category pair (a <= b); a balcony and its own
+    // tower touch by design and are not counted
+    size_t overlaps[BATCH_CATEGORY_COUNT][BATCH_CATEGORY_COUNT] = {};
+    size_t totalOverlaps = 0;
+    // Trees, bushes, houses and towers per hectare in each region, row-major from -X/-Z
+    std::vector<float> regionDensity;
+    float densityMin = 0.0f;
+    float densityMax = 0.0f;
+    float densityMean = 0.0f;
+    float densityVariation = 0.0f; // Standard deviation over the mean; 0 is perfectly even
+    size_t balconySides[BALCONY_SIDE_COUNT] = {};
+    size_t oneSidedTowers = 0;      // Towers with every balcony on the same side
+    size_t blockedBalconies = 0;    // Balconies intersecting any other object
+    double generateMs = 0.0;
+    double statsMs = 0.0;
+};
+
+struct BatchOptions {
+    unsigned int firstSeed = 1;
+    unsigned int seedCount = 100;    // At most BATCH_MAX_SEEDS
+    int scale = 1;                   // Object counts and area as makeScaledWorldGenParams()
+    int regions = BATCH_DEFAULT_REGIONS;
+    unsigned int threads = 0;        // 0 = all hardware threads
+};
+
+struct BatchRun {
+    std::vector<BatchWorldStats> worlds; // In seed order
+    unsigned int threads = 0;
+    double seconds = 0.0;
+    double worldsPerSecond = 0.0;
+};
+
+// Generates and measures every seed in the range. Touches no world globals.
+void runWorldBatch(const BatchOptions& options, BatchRun& run);
+void writeWorldBatch(std::ostream& out, const BatchOptions& options, const BatchRun& run, bool csv);
+// Command line front end shared by the forest_batch target and --batch:
+// [--seeds first-last] [--scale N] [--regions N] [--threads N] [--format json|csv] [--out file]
+// [--cache-seeds a,b,...] [--cache-dir dir] [--cache-format glb|obj]
+int runWorldBatchCommand(int argc, char** argv);
@@ -0,0 +1,118 @@
+#include "world_graph.h"
+
+#include <chrono>
+#include <cmath>
+
+const WorldGenNodeInfo WORLD_GEN_NODES[GEN_NODE_COUNT] = {
+    { "trees", OBJECT_TREE, GEN_INPUT_SEED | GEN_INPUT_AREA | GEN_INPUT_TREE_COUNT | GEN_INPUT_VARIATION, 0 },
+    { "bushes", OBJECT_BUSH, GEN_INPUT_SEED | GEN_INPUT_AREA | GEN_INPUT_BUSH_COUNT | GEN_INPUT_VARIATION, 0 },
+    { "houses", OBJECT_HOUSE, GEN_INPUT_SEED | GEN_INPUT_AREA | GEN_INPUT_HOUSE_COUNT | GEN_INPUT_VARIATION, 0 },
+    { "towers", OBJECT_TOWER, GEN_INPUT_SEED | GEN_INPUT_AREA | GEN_INPUT_TOWER_COUNT | GEN_INPUT_VARIATION, 0 },
+    { "balconies", OBJECT_BALCONY, GEN_INPUT_SEED | GEN_INPUT_BALCONIES_PER_TOWER | GEN_INPUT_VARIATION, 1u << GEN_TOWERS }
+};
+
+int& getWorldGenCount(WorldGenParams& params, WorldGenNode node) {
+    switch (node) {
+    case GEN_TREES: return params.treeCount;
+    case GEN_BUSHES: return params.bushCount;
+    case GEN_HOUSES: return params.houseCount;
+    case GEN_TOWERS: return params.towerCount;
+    default: return params.balconiesPerTower;
+    }
+}
+
+unsigned int diffWorldGenParams(const WorldGenParams& a, const WorldGenParams& b, unsigned int* variationNodes) {
+    unsigned int changed = 0;
+    if (a.seed != b.seed) changed |= GEN_INPUT_SEED;
+    if (a.areaSize != b.areaSize) changed |= GEN_INPUT_AREA;
+    if (a.treeCount != b.treeCount) changed |= GEN_INPUT_TREE_COUNT;
+    if (a.bushCount != b.bushCount) changed |= GEN_INPUT_BUSH_COUNT;
+    if (a.houseCount != b.houseCount) changed |= GEN_INPUT_HOUSE_COUNT;
+    if (a.towerCount != b.towerCount) changed |= GEN_INPUT_TOWER_COUNT;
+    if (a.balconiesPerTower != b.balconiesPerTower) changed |= GEN_INPUT_BALCONIES_PER_TOWER;
+    unsigned int nodes = 0;
+    for (int node = 0; node < GEN_NODE_COUNT; ++node) {
+        if (a.variation[node] != b.variation[node]) nodes |= 1u << node;
+    }
+    if (nodes) changed |= GEN_INPUT_VARIATION;
+    if (variationNodes) *variationNodes = nodes;
+    return changed;
+}
+
+static void generateNode(WorldGenNode node, const WorldGenParams& params) {
+    WorldRandom random;
+    invalidateCollisionGrid();
+    switch (node) {
+    case GEN_TREES:
+        random = makeWorldRandom(params.seed, SEED_STREAM_TREES, params.variation[node]);
+        generateObjectPositions(treePositions, params.areaSize, params.treeCount, random);
+        break;
+    case GEN_BUSHES:
+        random = makeWorldRandom(params.seed, SEED_STREAM_BUSHES, params.variation[node]);
+        generateObjectPositions(bushPositions, params.areaSize, params.bushCount, random);
+        break;
+    case GEN_HOUSES:
+        random = makeWorldRandom(params.seed, SEED_STREAM_HOUSES, params.variation[node]);
+        generateObjectPositions(housePositions, params.areaSize, params.houseCount, random);
+        break;
+    case GEN_TOWERS:
+        random = makeWorldRandom(params.seed, SEED_STREAM_TOWERS, params.variation[node]);
+        generateObjectPositions(apartmentTowerPositions, params.areaSize, params.towerCount, random);
+        break;
+    default:
+        generateBalconies(params.balconiesPerTower, makeWorldRandom(params.seed, SEED_STREAM_BALCONIES, params.variation[node]));
+        break;
+    }
+}
+
+unsigned int updateWorldGraph(WorldGenGraph& graph, const WorldGenParams& params) {
+    unsigned int variationNodes = 0;
+    unsigned int changedInputs = graph.built ? diffWorldGenParams(graph.params, params, &variationNodes) : ~0u;
+    unsigned int regenerated = 0;
+    for (int node = 0; node < GEN_NODE_COUNT; ++node) {
+        const WorldGenNodeInfo& info = WORLD_GEN_NODES[node];
+        unsigned int ownInputs = info.inputs & ~GEN_INPUT_VARIATION;
+        bool dirty = !graph.built || (changedInputs & ownInputs) != 0 || (variationNodes & (1u << node)) != 0 ||
+                     (regenerated & info.upstream) != 0;
+        if (!dirty) continue;
+
+        auto start = std::chrono::steady_clock::now();
+        generateNode(static_cast<WorldGenNode>(node), params);
+        graph.nodeMs[node] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        graph.versions[node]++;
+        regenerated |= 1u << node;
+    }
+    graph.params = params;
+    graph.built = true;
+    return regenerated;
+}
+
+WorldGenParams makeScaledWorldGenParams(unsigned int seed, int scale) {
+    WorldGenParams params;
+    params.seed = seed;
+    params.areaSize = getScaledAreaSize(scale);
+    params.treeCount = TREE_COUNT * scale;
+    params.bushCount = BUSH_COUNT * scale;
+    params.houseCount = HOUSE_COUNT * scale;
+    params.towerCount = APARTMENT_TOWER_COUNT * scale;
+    return params;
+}
+
+void generateScaledWorld(unsigned int seed, int scale) {
+    WorldGenGraph graph;
+    updateWorldGraph(graph, makeScaledWorldGenParams(seed, scale));
+}
+
+float getScaledAreaSize(int scale) {
+    return GROUND_SIZE * std::sqrt(static_cast<float>(scale));
+}
+
+float randomAreaCoordinate(WorldRandom& random, float areaSize) {
+    return worldRandomFloat(random) * areaSize - areaSize / 2.0f;
+}
+
+glm::vec3 randomAreaPoint(WorldRandom& random, float areaSize, float y) {
+    float x = randomAreaCoordinate(random, areaSize);
+    float z = randomAreaCoordinate(random, areaSize);
+    return glm::vec3(x, y, z);
+}
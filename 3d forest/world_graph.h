@@ -0,0 +1,79 @@
+// World generation graph: each generated category is a node with its own seed stream and a
+// declared set of inputs (parameters and upstream nodes). updateWorldGraph() regenerates only
+// the nodes whose inputs changed since the last update, so tweaking one count at runtime
+// rebuilds that category (and what derives from it) instead of reshuffling the whole world.
+#pragma once
+
+#include <cstdint>
+
+#include "world.h"
+
+enum WorldGenNode {
+    GEN_TREES = 0,
+    GEN_BUSHES,
+    GEN_HOUSES,
+    GEN_TOWERS,
+    GEN_BALCONIES, // Hangs off the towers
+    GEN_NODE_COUNT
+};
+
+// Parameter bits, used to declare what each node reads
+enum WorldGenInput {
+    GEN_INPUT_SEED = 1 << 0,
+    GEN_INPUT_AREA = 1 << 1,
+    GEN_INPUT_TREE_COUNT = 1 << 2,
+    GEN_INPUT_BUSH_COUNT = 1 << 3,
+    GEN_INPUT_HOUSE_COUNT = 1 << 4,
+    GEN_INPUT_TOWER_COUNT = 1 << 5,
+    GEN_INPUT_BALCONIES_PER_TOWER = 1 << 6,
+    GEN_INPUT_VARIATION = 1 << 7 // The node's own entry in WorldGenParams::variation
+};
+
+struct WorldGenNodeInfo {
+    const char* name;
+    WorldObjectType object;  // The position array it fills
+    unsigned int inputs;     // WorldGenInput bits
+    unsigned int upstream;   // Bits of the WorldGenNodes it reads
+};
+// In dependency order
+extern const WorldGenNodeInfo WORLD_GEN_NODES[GEN_NODE_COUNT];
+
+struct WorldGenParams {
+    unsigned int seed = 1;
+    float areaSize = GROUND_SIZE;
+    int treeCount = TREE_COUNT;
+    int bushCount = BUSH_COUNT;
+    int houseCount = HOUSE_COUNT;
+    int towerCount = APARTMENT_TOWER_COUNT;
+    int balconiesPerTower = BALCONIES_PER_TOWER;
+    uint32_t variation[GEN_NODE_COUNT] = {}; // Bump one to re-roll just that node
+};
+
+struct WorldGenGraph {
+    bool built = false;
+    WorldGenParams params;                 // What the current world was generated from
+    uint32_t versions[GEN_NODE_COUNT] = {}; // Incremented whenever the node is regenerated
+    double nodeMs[GEN_NODE_COUNT] = {};    // Duration of the node's last regeneration
+};
+
+// The count parameter a node is sized by (objects, or balconies per tower)
+int& getWorldGenCount(WorldGenParams& params, WorldGenNode node);
+
+// WorldGenInput bits that differ between two parameter sets. Variations are per node, so a
+// variation change is reported through `variationNodes` (WorldGenNode bits) instead.
+unsigned int diffWorldGenParams(const WorldGenParams& a, const WorldGenParams& b, unsigned int* variationNodes);
+// Brings the world globals up to `params`, regenerating dirty nodes in dependency order (all of
+// them on the first call). Returns the WorldGenNode bits that were regenerated.
+unsigned int updateWorldGraph(WorldGenGraph& graph, const WorldGenParams& params);
+
+// Default parameters with `scale` times the object counts over `scale` times the area, so the
+// density stays the same. Used by the benchmarks.
+WorldGenParams makeScaledWorldGenParams(unsigned int seed, int scale);
+void generateScaledWorld(unsigned int seed, int scale);
+// Side of the square ground of such a world
+float getScaledAreaSize(int scale);
+// Uniform over [-areaSize / 2, areaSize / 2], for benchmark query positions
+float randomAreaCoordinate(WorldRandom& random, float areaSize);
+// X then Z from randomAreaCoordinate(), at height y. Use this rather than two calls in one
+// expression, whose evaluation order differs between compilers.
+glm::vec3 randomAreaPoint(WorldRandom& random, float areaSize, float y);
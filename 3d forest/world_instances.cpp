@@ -0,0 +1,244 @@
+#include "world_instances.h"
+#include "world_graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+static void markDirty(WorldInstances& instances, uint32_t slot) {
+    if (instances.dirtyFlags[slot]) return;
+    instances.dirtyFlags[slot] = 1;
+    instances.dirtySlots.push_back(slot);
+}
+
+// Reuse a freed slot if there is one, otherwise grow the slot arrays
+static uint32_t allocateSlot(WorldInstances& instances, const WorldPart& part) {
+    uint32_t slot;
+    if (!instances.freeSlots.empty()) {
+        slot = instances.freeSlots.back();
+        instances.freeSlots.pop_back();
+        instances.parts[slot] = part;
+        instances.alive[slot] = 1;
+    }
+    else {
+        slot = static_cast<uint32_t>(instances.parts.size());
+        instances.parts.push_back(part);
+        instances.alive.push_back(1);
+        instances.dirtyFlags.push_back(0);
+    }
+    instances.liveCountByType[part.type]++;
+    markDirty(instances, slot);
+    return slot;
+}
+
+static void releaseSlot(WorldInstances& instances, uint32_t slot) {
+    instances.alive[slot] = 0;
+    instances.liveCountByType[instances.parts[slot].type]--;
+    instances.freeSlots.push_back(slot);
+    markDirty(instances, slot);
+}
+
+void buildWorldInstances(WorldInstances& instances) {
+    // Empty every array (binding it to the arena), then take the memory back in one go
+    ArenaAllocator<char> allocator(&instances.arena);
+    instances.parts = ArenaVector<WorldPart>(allocator);
+    instances.alive = ArenaVector<uint8_t>(allocator);
+    instances.freeSlots = ArenaVector<uint32_t>(allocator);
+    for (int type = 0; type < OBJECT_TYPE_COUNT; ++type) instances.objectSlots[type] = ArenaVector<uint32_t>(allocator);
+    instances.dirtySlots = ArenaVector<uint32_t>(allocator);
+    instances.dirtyFlags = ArenaVector<uint8_t>(allocator);
+    size_t total = countWorldParts(instances.liveCountByType);
+    resetArena(instances.arena, total * (sizeof(WorldPart) + sizeof(uint32_t) + 2) + (OBJECT_TYPE_COUNT + 3) * ARENA_ALIGNMENT);
+
+    instances.parts.resize(total);
+    getWorldParts(0, total, instances.parts.data());
+    instances.alive.assign(total, 1);
+    instances.dirtyFlags.assign(total, 0);
+
+    // getWorldParts() runs object type by object type, so each type's slots are one run
+    uint32_t slot = 0;
+    for (int type = 0; type < OBJECT_TYPE_COUNT; ++type) {
+        size_t slotCount = getWorldObjectCount(static_cast<WorldObjectType>(type)) * WORLD_OBJECT_PART_COUNTS[type];
+        instances.objectSlots[type].resize(slotCount);
+        for (size_t i = 0; i < slotCount; ++i) instances.objectSlots[type][i] = slot++;
+    }
+}
+
+size_t placeInstancedObject(WorldInstances& instances, WorldObjectType type, glm::vec3 basePosition) {
+    if (!isWorldObjectEditable(type)) {
+        std::cerr << "ERROR::WORLD::OBJECT_NOT_EDITABLE " << type << std::endl;
+        return 0;
+    }
+    size_t index = addWorldObject(type, basePosition);
+    WorldPart parts[MAX_PARTS_PER_OBJECT];
+    getWorldObjectParts(type, index, parts);
+    for (size_t p = 0; p < WORLD_OBJECT_PART_COUNTS[type]; ++p) {
+        instances.objectSlots[type].push_back(allocateSlot(instances, parts[p]));
+    }
+    return index;
+}
+
+void removeInstancedObject(WorldInstances& instances, WorldObjectType type, size_t index) {
+    if (!isWorldObjectEditable(type) || index >= getWorldObjectCount(type)) {
+        std::cerr << "ERROR::WORLD::INVALID_OBJECT_REMOVAL " << type << " " << index << std::endl;
+        return;
+    }
+    size_t perObject = WORLD_OBJECT_PART_COUNTS[type];
+    ArenaVector<uint32_t>& slots = instances.objectSlots[type];
+    for (size_t p = 0; p < perObject; ++p) releaseSlot(instances, slots[index * perObject + p]);
+
+    // The world moved its last object into `index`; its slots follow it, their parts are unchanged
+    size_t movedFrom = removeWorldObject(type, index);
+    if (movedFrom != index) {
+        for (size_t p = 0; p < perObject; ++p) slots[index * perObject + p] = slots[movedFrom * perObject + p];
+    }
+    slots.resize(slots.size() - perObject);
+}
+
+size_t rebuildInstancedObjects(WorldInstances& instances, WorldObjectType type) {
+    size_t dirtyBefore = instances.dirtySlots.size();
+    size_t perObject = WORLD_OBJECT_PART_COUNTS[type];
+    size_t count = getWorldObjectCount(type);
+    ArenaVector<uint32_t>& slots = instances.objectSlots[type];
+    for (size_t k = count * perObject; k < slots.size(); ++k) releaseSlot(instances, slots[k]);
+    if (slots.size() > count * perObject) slots.resize(count * perObject);
+    size_t keptSlots = slots.size();
+    WorldPart parts[MAX_PARTS_PER_OBJECT];
+    for (size_t i = 0; i < count; ++i) {
+        getWorldObjectParts(type, i, parts);
+        for (size_t p = 0; p < perObject; ++p) {
+            size_t k = i * perObject + p;
+            if (k < keptSlots) {
+                // Same part type, so the live counts hold. Streams are prefix-stable: when only the
+                // count changed, the existing objects are unchanged and stay clean.
+                WorldPart& part = instances.parts[slots[k]];
+                if (part.center == parts[p].center && part.size == parts[p].size) continue;
+                part = parts[p];
+                markDirty(instances, slots[k]);
+            }
+            else {
+                slots.push_back(allocateSlot(instances, parts[p]));
+            }
+        }
+    }
+    return instances.dirtySlots.size() - dirtyBefore;
+}
+
+void takeDirtyRanges(WorldInstances& instances, std::vector<InstanceRange>& ranges) {
+    ranges.clear();
+    ArenaVector<uint32_t>& dirty = instances.dirtySlots;
+    std::sort(dirty.begin(), dirty.end());
+    for (uint32_t slot : dirty) {
+        instances.dirtyFlags[slot] = 0;
+        if (!ranges.empty() && slot <= ranges.back().first + ranges.back().count + INSTANCE_RANGE_MERGE_GAP) {
+            ranges.back().count = slot - ranges.back().first + 1;
+        }
+        else {
+            InstanceRange range = { slot, 1 };
+            ranges.push_back(range);
+        }
+    }
+    dirty.clear();
+}
+
+// --- Edit Upload Report ---
+void addInstanceUpload(InstanceUploadReport& report, const std::vector<InstanceRange>& ranges, size_t uploadBytes) {
+    report.frames++;
+    for (const InstanceRange& range : ranges) report.dirtySlots += range.count;
+    report.dirtyRanges += ranges.size();
+    report.uploadBytes += uploadBytes;
+}
+
+void updateInstanceUploadReport(InstanceUploadReport& report, size_t fullUploadBytes, double now) {
+    if (now - report.lastReportTime < INSTANCE_REPORT_SECONDS) return;
+    if (report.frames > 0) {
+        std::cout << "World edits: " << report.frames << " frames with edits, " << report.dirtySlots << " dirty slots in "
+                  << report.dirtyRanges << " ranges, " << report.uploadBytes << " bytes uploaded (a full upload is "
+                  << fullUploadBytes << " bytes)" << std::endl;
+    }
+    report = InstanceUploadReport();
+    report.lastReportTime = now;
+}
+
+// --- Benchmark ---
+// Every live slot must hold the current part of exactly one object
+static bool instancesMatchWorld(const WorldInstances& instances) {
+    size_t live = 0;
+    for (uint8_t a : instances.alive) live += a;
+    if (live != countWorldParts() || live + instances.freeSlots.size() != instances.parts.size()) return false;
+    WorldPart parts[MAX_PARTS_PER_OBJECT];
+    for (int type = 0; type < OBJECT_TYPE_COUNT; ++type) {
+        size_t perObject = WORLD_OBJECT_PART_COUNTS[type];
+        size_t count = getWorldObjectCount(static_cast<WorldObjectType>(type));
+        if (instances.objectSlots[type].size() != count * perObject) return false;
+        for (size_t i = 0; i < count; ++i) {
+            getWorldObjectParts(static_cast<WorldObjectType>(type), i, parts);
+            for (size_t p = 0; p < perObject; ++p) {
+                uint32_t slot = instances.objectSlots[type][i * perObject + p];
+                if (!instances.alive[slot] || instances.parts[slot].type != parts[p].type ||
+                    instances.parts[slot].center != parts[p].center || instances.parts[slot].size != parts[p].size) return false;
+            }
+        }
+    }
+    return true;
+}
+
+void runWorldEditBenchmark() {
+    const int scales[] = { 1, 10, 100 };
+    const int EDIT_FRAMES = 5000;
+    const int EDITS_PER_FRAME = 4;    // Alternating place and remove, so the world size holds steady
+    const int COLLISION_QUERIES = 200000;
+    const WorldObjectType editTypes[] = { OBJECT_TREE, OBJECT_BUSH, OBJECT_HOUSE };
+    std::cout << std::fixed;
+    std::cout.precision(2);
+    for (int scale : scales) {
+        WorldRandom queryRandom = makeWorldRandom(1, SEED_STREAM_QUERIES); // Same edits on every platform
+        float area = getScaledAreaSize(scale);
+        generateScaledWorld(1, scale);
+
+        auto start = std::chrono::steady_clock::now();
+        checkCollision(glm::vec3(0.0f)); // Builds the grid
+        double gridMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        WorldInstances instances;
+        start = std::chrono::steady_clock::now();
+        buildWorldInstances(instances);
+        double rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<InstanceRange> ranges;
+        size_t dirtySlots = 0, dirtyRanges = 0;
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < EDIT_FRAMES; ++frame) {
+            for (int e = 0; e < EDITS_PER_FRAME; ++e) {
+                WorldObjectType type = editTypes[worldRandomIndex(queryRandom, 3)];
+                size_t count = getWorldObjectCount(type);
+                if (e % 2 == 0 || count == 0) {
+                    placeInstancedObject(instances, type, randomAreaPoint(queryRandom, area, GROUND_LEVEL));
+                }
+                else {
+                    removeInstancedObject(instances, type, worldRandomIndex(queryRandom, static_cast<uint32_t>(count)));
+                }
+            }
+            takeDirtyRanges(instances, ranges);
+            for (const InstanceRange& range : ranges) dirtySlots += range.count;
+            dirtyRanges += ranges.size();
+        }
+        double editNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (EDIT_FRAMES * EDITS_PER_FRAME);
+
+        int collisions = 0;
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < COLLISION_QUERIES; ++q) {
+            collisions += checkCollision(randomAreaPoint(queryRandom, area, GROUND_LEVEL + PLAYER_EYE_HEIGHT));
+        }
+        double collisionNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / COLLISION_QUERIES;
+
+        std::cout << "[editbench] " << scale << "x world: " << instances.parts.size() << " slots, grid build " << gridMs << " ms, full slot rebuild "
+                  << rebuildMs << " ms" << std::endl;
+        std::cout << "[editbench]   " << editNs << " ns per edit (incl. dirty-range merge), "
+                  << static_cast<double>(dirtySlots) / EDIT_FRAMES << " dirty slots in "
+                  << static_cast<double>(dirtyRanges) / EDIT_FRAMES << " ranges per frame (a full upload is "
+                  << instances.parts.size() << "), " << instances.freeSlots.size() << " free slots" << std::endl;
+        std::cout << "[editbench]   checkCollision " << collisionNs << " ns per query (" << collisions << " hits), slots "
+                  << (instancesMatchWorld(instances) ? "consistent" : "INCONSISTENT") << " with the world" << std::endl;
+    }
+}
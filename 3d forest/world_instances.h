@@ -0,0 +1,62 @@
+// Stable draw slots for every world part, so editing the world only touches the slots of the
+// objects added or removed. Freed slots go on a free list and are reused; changed slots are
+// recorded as dirty and handed to the renderer once per frame as merged ranges to upload.
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "world.h"
+
+// --- Instance Configuration ---
+const uint32_t INSTANCE_RANGE_MERGE_GAP = 8; // Dirty slots this close are uploaded as one range
+const double INSTANCE_REPORT_SECONDS = 10.0;  // Interval between edit upload reports on stdout
+
+struct InstanceRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct WorldInstances {
+    Arena arena{ MEMORY_GEOMETRY }; // Backs every array below; reset by buildWorldInstances()
+    ArenaVector<WorldPart> parts;   // By slot; a dead slot keeps its last part until reused
+    ArenaVector<uint8_t> alive;     // By slot
+    ArenaVector<uint32_t> freeSlots;
+    // WORLD_OBJECT_PART_COUNTS[type] slots per object, in object index order
+    ArenaVector<uint32_t> objectSlots[OBJECT_TYPE_COUNT];
+    ArenaVector<uint32_t> dirtySlots;
+    ArenaVector<uint8_t> dirtyFlags; // By slot
+    size_t liveCountByType[PART_COUNT] = {};
+};
+
+// Slots in getWorldParts() order for the current world, nothing dirty. Releases the previous
+// slot arrays in bulk.
+void buildWorldInstances(WorldInstances& instances);
+// addWorldObject()/removeWorldObject() plus the slot bookkeeping. Returns the new object index.
+size_t placeInstancedObject(WorldInstances& instances, WorldObjectType type, glm::vec3 basePosition);
+void removeInstancedObject(WorldInstances& instances, WorldObjectType type, size_t index);
+// After `type` was regenerated: its existing slots are rewritten in place, extra objects get new
+// slots and surplus slots are freed, so only that type's slots become dirty. Returns the dirty slots.
+size_t rebuildInstancedObjects(WorldInstances& instances, WorldObjectType type);
+// Sorted, merged ranges of the slots changed since the last call; clears the dirty set.
+void takeDirtyRanges(WorldInstances& instances, std::vector<InstanceRange>& ranges);
+
+// --- Edit Upload Report ---
+// Dirty slots, ranges and bytes uploaded by edits are summed over frames and printed every
+// INSTANCE_REPORT_SECONDS (only if anything was edited), keeping the output out of the frame.
+struct InstanceUploadReport {
+    size_t frames = 0;        // Frames with an edit since the last report
+    size_t dirtySlots = 0;
+    size_t dirtyRanges = 0;
+    size_t uploadBytes = 0;
+    double lastReportTime = 0.0;
+};
+void addInstanceUpload(InstanceUploadReport& report, const std::vector<InstanceRange>& ranges, size_t uploadBytes);
+// `fullUploadBytes`: what uploading every slot would cost, for comparison
+void updateInstanceUploadReport(InstanceUploadReport& report, size_t fullUploadBytes, double now);
+
+// Random place/remove churn at several world sizes: edit cost, dirty slots per frame and
+// collision query cost, against a full rebuild of the slots.
+void runWorldEditBenchmark();
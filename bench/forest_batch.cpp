@@ -0,0 +1,7 @@
+// Entry point of the headless forest_batch target (see CMakeLists.txt). The game runs the same
+// generator with --batch.
+#include "world_batch.h"
+
+int main(int argc, char** argv) {
+    return runWorldBatchCommand(argc, argv);
+}
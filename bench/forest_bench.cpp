@@ -0,0 +1,7 @@
+// Entry point of the headless forest_bench target (see CMakeLists.txt). The game itself runs
+// the same suite with --microbench.
+#include "benchmark.h"
+
+int main(int argc, char** argv) {
+    return runMicroBenchmarkCommand(argc, argv);
+}